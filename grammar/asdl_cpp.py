@@ -405,6 +405,542 @@ class ASTWalkVisitorVisitor(ASDLVisitor):
             self.emit(  "this->visit_symbol(*a.second);", 3)
             self.emit("}", 2)
 
+# This class generates a walk visitor that visits the same nodes in the same
+# order as the one above, but without recursion
+class IterativeWalkVisitorVisitor(ASDLVisitor):
+
+    def visitModule(self, mod):
+        self.emit("/" + "*"*78 + "/")
+        self.emit("// Iterative Walk Visitor base class")
+        self.emit("")
+        self.emit("// Visits the same nodes in the same order as BaseWalkVisitor, but keeps the")
+        self.emit("// nodes that are still to be visited on an explicit stack instead of")
+        self.emit("// recursing, so that arbitrarily deep trees can be walked. The visit_*()")
+        self.emit("// methods of this class only schedule the children of the node: a derived")
+        self.emit("// visitor can act on a node before its children are visited, but not after.")
+        self.emit("template <class Derived>")
+        self.emit("class BaseIterativeWalkVisitor : public BaseVisitor<Derived>")
+        self.emit("{")
+        self.emit("private:")
+        self.emit("    Derived& self() { return static_cast<Derived&>(*this); }")
+        self.emit("")
+        types = [dfn.name for dfn in mod.dfns
+            if not (isinstance(dfn.value, asdl.Sum) and is_simple_sum(dfn.value))]
+        has_scopes = "symbol" in types
+        items = ["%s_item" % t for t in types]
+        if has_scopes:
+            items.append("scope_item")
+        self.emit("    enum ItemType { %s };" % ", ".join(items))
+        self.emit("    struct Item {")
+        self.emit("        ItemType type;")
+        self.emit("        const void *x;")
+        self.emit("    };")
+        self.emit("    std::vector<Item> stack;")
+        self.emit("    bool walking = false;")
+        self.emit("")
+        self.emit("    void push(ItemType type, const void *x) {")
+        self.emit("        stack.push_back({type, x});")
+        self.emit("    }")
+        self.emit("")
+        self.emit("    // Visits the scheduled nodes, unless an outer call is already doing so.")
+        self.emit("    // The children of a node are pushed in reverse order, so that they are")
+        self.emit("    // visited in order.")
+        self.emit("    void walk() {")
+        self.emit("        if (walking) return;")
+        self.emit("        walking = true;")
+        self.emit("        while (!stack.empty()) {")
+        self.emit("            Item item = stack.back();")
+        self.emit("            stack.pop_back();")
+        self.emit("            switch (item.type) {")
+        for t in types:
+            self.emit("                case %s_item: self().visit_%s(*(const %s_t*)item.x); break;" % (t, t, t))
+        if has_scopes:
+            self.emit("                // Like BaseWalkVisitor, which does not call the visit_symbol()")
+            self.emit("                // of the derived class for the symbol tables")
+            self.emit("                case scope_item: BaseVisitor<Derived>::visit_symbol(*(const symbol_t*)item.x); break;")
+        self.emit("            }")
+        self.emit("        }")
+        self.emit("        walking = false;")
+        self.emit("    }")
+        self.emit("public:")
+        super(IterativeWalkVisitorVisitor, self).visitModule(mod)
+        self.emit("};")
+
+    def visitType(self, tp):
+        if not (isinstance(tp.value, asdl.Sum) and
+                is_simple_sum(tp.value)):
+            super(IterativeWalkVisitorVisitor, self).visitType(tp, tp.name)
+
+    def visitProduct(self, prod, name):
+        self.make_visitor(name, prod.fields)
+
+    def visitConstructor(self, cons, _):
+        self.make_visitor(cons.name, cons.fields)
+
+    def make_visitor(self, name, fields):
+        self.emit("void visit_%s(const %s_t &x) {" % (name, name), 1)
+        self.used = False
+        for field in reversed(fields):
+            self.visitField(field)
+        if self.used:
+            self.emit("walk();", 2)
+        else:
+            self.emit("if ((bool&)x) { } // Suppress unused warning", 2)
+        self.emit("}", 1)
+
+    def use(self):
+        self.used = True
+
+    def visitField(self, field):
+        if (field.type not in asdl.builtin_types and
+            field.type not in self.data.simple_types):
+            if field.type == "symbol":
+                return
+            level = 2
+            if field.seq:
+                self.use()
+                self.emit("for (size_t i=x.n_%s; i-- > 0;) {" % field.name, level)
+                if field.type in products:
+                    self.emit("    push(%s_item, &x.m_%s[i]);" % (field.type, field.name), level)
+                else:
+                    self.emit("    push(%s_item, x.m_%s[i]);" % (field.type, field.name), level)
+                self.emit("}", level)
+            else:
+                self.use()
+                if field.opt:
+                    self.emit("if (x.m_%s)" % field.name, 2)
+                    level = 3
+                if field.type in products and not field.opt:
+                    self.emit("push(%s_item, &x.m_%s);" % (field.type, field.name), level)
+                else:
+                    self.emit("push(%s_item, x.m_%s);" % (field.type, field.name), level)
+        elif field.type == "symbol_table" and field.name in["symtab",
+                "global_scope"]:
+            self.use()
+            self.emit("const auto &scope = x.m_%s->get_scope();" % field.name, 2)
+            self.emit("for (auto a = scope.rbegin(); a != scope.rend(); ++a) {", 2)
+            self.emit(  "push(scope_item, a->second);", 3)
+            self.emit("}", 2)
+
+# This class generates a walk visitor that also visits all strings
+# (`identifier` and `string` fields), so that they can be replaced, and the
+# `node` fields, which the walk visitor skips
+class StringWalkVisitorVisitor(ASDLVisitor):
+
+    def visitModule(self, mod):
+        self.emit("/" + "*"*78 + "/")
+        self.emit("// String Walk Visitor base class")
+        self.emit("")
+        self.emit("template <class Derived>")
+        self.emit("class BaseStringWalkVisitor : public BaseWalkVisitor<Derived>")
+        self.emit("{")
+        self.emit("private:")
+        self.emit("    Derived& self() { return static_cast<Derived&>(*this); }")
+        self.emit("public:")
+        self.emit("// Called for every string, which can be replaced", 1)
+        self.emit("void visit_string(char *&/*s*/) {}", 1)
+        self.emit("// Called for every array of strings before its elements", 1)
+        self.emit("void visit_string_array(char **&/*a*/, size_t /*n*/) {}", 1)
+        self.mod = mod
+        super(StringWalkVisitorVisitor, self).visitModule(mod)
+        self.emit("};")
+
+    def visitType(self, tp):
+        if not (isinstance(tp.value, asdl.Sum) and
+                is_simple_sum(tp.value)):
+            super(StringWalkVisitorVisitor, self).visitType(tp, tp.name)
+
+    def visitProduct(self, prod, name):
+        self.make_visitor(name, prod.fields)
+
+    def visitConstructor(self, cons, _):
+        self.make_visitor(cons.name, cons.fields)
+
+    def make_visitor(self, name, fields):
+        fields = [field for field in fields
+            if field.type in ["identifier", "string", "node"]]
+        if not fields:
+            return
+        self.emit("void visit_%s(const %s_t &x) {" % (name, name), 1)
+        self.emit("BaseWalkVisitor<Derived>::visit_%s(x);" % name, 2)
+        for field in fields:
+            if field.type == "node":
+                assert field.seq
+                self.emit("for (size_t i=0; i<x.n_%s; i++) {" % field.name, 2)
+                self.emit("    self().visit_%s(*x.m_%s[i]);" \
+                    % (self.mod.name.lower(), field.name), 2)
+                self.emit("}", 2)
+            elif field.seq:
+                self.emit("self().visit_string_array(const_cast<char**&>(x.m_%s), x.n_%s);" \
+                    % (field.name, field.name), 2)
+                self.emit("for (size_t i=0; i<x.n_%s; i++) {" % field.name, 2)
+                self.emit("    self().visit_string(x.m_%s[i]);" % field.name, 2)
+                self.emit("}", 2)
+            elif field.opt:
+                self.emit("if (x.m_%s)" % field.name, 2)
+                self.emit("self().visit_string(const_cast<char*&>(x.m_%s));" \
+                    % field.name, 3)
+            else:
+                self.emit("self().visit_string(const_cast<char*&>(x.m_%s));" \
+                    % field.name, 2)
+        self.emit("}", 1)
+
+# This class generates a bitset of the `stmt` and `expr` kinds (one bit for
+# each constructor) and a walk visitor that collects the kinds in a subtree
+class SubtreeKindsVisitorVisitor(ASDLVisitor):
+
+    def visitModule(self, mod):
+        counts = {}
+        for dfn in mod.dfns:
+            if dfn.name in ["stmt", "expr"]:
+                counts[dfn.name] = len(dfn.value.types)
+        self.emit("/" + "*"*78 + "/")
+        self.emit("// Subtree kinds")
+        self.emit("")
+        self.emit("// The `stmt` and `expr` kinds that occur in a subtree, one bit for each kind")
+        self.emit("const size_t n_stmt_kinds = %d;" % counts["stmt"])
+        self.emit("const size_t n_expr_kinds = %d;" % counts["expr"])
+        self.emit("typedef std::bitset<n_stmt_kinds + n_expr_kinds> SubtreeKinds;")
+        self.emit("")
+        self.emit("static inline SubtreeKinds kinds_of(stmtType t) {")
+        self.emit("return SubtreeKinds().set((size_t)t);", 1)
+        self.emit("}")
+        self.emit("")
+        self.emit("static inline SubtreeKinds kinds_of(exprType t) {")
+        self.emit("return SubtreeKinds().set(n_stmt_kinds + (size_t)t);", 1)
+        self.emit("}")
+        self.emit("")
+        self.emit("static inline SubtreeKinds all_kinds() {")
+        self.emit("return SubtreeKinds().set();", 1)
+        self.emit("}")
+        self.emit("")
+        self.emit("class SubtreeKindsVisitor : public BaseWalkVisitor<SubtreeKindsVisitor>")
+        self.emit("{")
+        self.emit("public:")
+        self.emit("SubtreeKinds kinds;", 1)
+        self.emit("void visit_stmt(const stmt_t &x) {", 1)
+        self.emit("kinds.set((size_t)x.type);", 2)
+        self.emit("BaseWalkVisitor::visit_stmt(x);", 2)
+        self.emit("}", 1)
+        self.emit("void visit_expr(const expr_t &x) {", 1)
+        self.emit("kinds.set(n_stmt_kinds + (size_t)x.type);", 2)
+        self.emit("BaseWalkVisitor::visit_expr(x);", 2)
+        self.emit("}", 1)
+        self.emit("};")
+        self.emit("")
+        self.emit("static inline SubtreeKinds subtree_kinds(const stmt_t &x) {")
+        self.emit("SubtreeKindsVisitor v;", 1)
+        self.emit("v.visit_stmt(x);", 1)
+        self.emit("return v.kinds;", 1)
+        self.emit("}")
+
+
+# This class generates a visitor that hashes the contents of the nodes,
+# without their locations
+class StructuralHashVisitorVisitor(ASDLVisitor):
+
+    def visitModule(self, mod):
+        self.emit("/" + "*"*78 + "/")
+        self.emit("// Structural Hash Visitor base class")
+        self.emit("")
+        self.emit("// Computes in `hash` a hash of the node types and field values of the")
+        self.emit("// visited node and its children, without the locations. The derived class")
+        self.emit("// must implement mix_symbol_ref(), which hashes a referenced symbol, and can")
+        self.emit("// override the mix_<type>() methods to cache the hashes of the children.")
+        self.emit("template <class Derived>")
+        self.emit("class StructuralHashBaseVisitor : public BaseVisitor<Derived>")
+        self.emit("{")
+        self.emit("private:")
+        self.emit(  "Derived& self() { return static_cast<Derived&>(*this); }", 1)
+        self.emit("public:")
+        self.emit(  "uint64_t hash = 0;", 1)
+        self.emit("")
+        self.emit(  "void mix(uint64_t v) {", 1)
+        self.emit(      "// The 64-bit finalizer of MurmurHash3", 2)
+        self.emit(      "uint64_t h = hash * 0x9e3779b97f4a7c15ULL + v + 1;", 2)
+        self.emit(      "h ^= h >> 33;", 2)
+        self.emit(      "h *= 0xff51afd7ed558ccdULL;", 2)
+        self.emit(      "h ^= h >> 33;", 2)
+        self.emit(      "h *= 0xc4ceb9fe1a85ec53ULL;", 2)
+        self.emit(      "h ^= h >> 33;", 2)
+        self.emit(      "hash = h;", 2)
+        self.emit(  "}", 1)
+        self.emit(  "void mix_float(double d) {", 1)
+        self.emit(      "uint64_t v;", 2)
+        self.emit(      "std::memcpy(&v, &d, sizeof(v));", 2)
+        self.emit(      "mix(v);", 2)
+        self.emit(  "}", 1)
+        self.emit(  "void mix_string(const char *s) {", 1)
+        self.emit(      "if (!s) {", 2)
+        self.emit(          "mix(0);", 3)
+        self.emit(          "return;", 3)
+        self.emit(      "}", 2)
+        self.emit(      "// FNV-1a", 2)
+        self.emit(      "uint64_t h = 0xcbf29ce484222325ULL;", 2)
+        self.emit(      "size_t n = 0;", 2)
+        self.emit(      "for (; s[n]; n++) {", 2)
+        self.emit(          "h = (h ^ (unsigned char)s[n]) * 0x100000001b3ULL;", 3)
+        self.emit(      "}", 2)
+        self.emit(      "mix(n + 1);", 2)
+        self.emit(      "mix(h);", 2)
+        self.emit(  "}", 1)
+        for name in sums + [mod.name.lower()]:
+            if name in simple_sums:
+                continue
+            self.emit(  "// Mixes in the hash of the child `x`", 1)
+            self.emit(  "void mix_%s(const %s_t &x) {" % (name, name), 1)
+            self.emit(      "uint64_t h = hash;", 2)
+            self.emit(      "hash = 0;", 2)
+            self.emit(      "self().visit_%s(x);" % name, 2)
+            self.emit(      "uint64_t child = hash;", 2)
+            self.emit(      "hash = h;", 2)
+            self.emit(      "mix(child);", 2)
+            self.emit(  "}", 1)
+        self.mod = mod
+        super(StructuralHashVisitorVisitor, self).visitModule(mod)
+        self.emit("};")
+
+    def visitType(self, tp):
+        if not (isinstance(tp.value, asdl.Sum) and
+                is_simple_sum(tp.value)):
+            super(StructuralHashVisitorVisitor, self).visitType(tp, tp.name)
+
+    def visitProduct(self, prod, name):
+        self.make_visitor(name, prod.fields, False)
+
+    def visitConstructor(self, cons, _):
+        self.make_visitor(cons.name, cons.fields, True)
+
+    def make_visitor(self, name, fields, cons):
+        self.emit("void visit_%s(const %s_t &x) {" % (name, name), 1)
+        if cons:
+            self.emit("self().mix(x.base.type);", 2)
+        self.used = cons
+        for field in fields:
+            self.visitField(field)
+        if not self.used:
+            self.emit("if ((bool&)x) { } // Suppress unused warning", 2)
+        self.emit("}", 1)
+
+    def emit_value(self, field, value):
+        # Emits the hashing of one value of the field
+        if field.type == "symbol":
+            return "self().mix_symbol_ref(*%s);" % value
+        elif field.type in products:
+            return "self().visit_%s(%s);" % (field.type, value)
+        elif field.type in ["identifier", "string"]:
+            return "self().mix_string(%s);" % value
+        elif field.type == "float":
+            return "self().mix_float(%s);" % value
+        elif field.type in ["int", "bool"] or \
+                field.type in self.data.simple_types:
+            return "self().mix(%s);" % value
+        elif field.type == "node":
+            return "self().mix_%s(*%s);" % (self.mod.name.lower(), value)
+        else:
+            return "self().mix_%s(*%s);" % (field.type, value)
+
+    def visitField(self, field):
+        if field.type == "symbol_table":
+            assert not field.seq and not field.opt
+            # The parent symbol table is not part of the node
+            if field.name == "parent_symtab":
+                return
+            self.used = True
+            self.emit("self().mix(x.m_%s->get_scope().size());" % field.name, 2)
+            self.emit("for (auto &a : x.m_%s->get_scope()) {" % field.name, 2)
+            self.emit(    "self().mix_string(a.first.c_str());", 3)
+            self.emit(    "self().mix_symbol(*a.second);", 3)
+            self.emit("}", 2)
+            return
+        self.used = True
+        pointer = field.type not in asdl.builtin_types and \
+            field.type not in self.data.simple_types and \
+            field.type not in products
+        if field.seq:
+            value = "x.m_%s[i]" % field.name
+            if field.type in products:
+                value = "x.m_%s[i]" % field.name
+            self.emit("self().mix(x.n_%s);" % field.name, 2)
+            self.emit("for (size_t i=0; i<x.n_%s; i++) {" % field.name, 2)
+            self.emit(    self.emit_value(field, value), 3)
+            self.emit("}", 2)
+        elif field.opt and (pointer or field.type in products):
+            value = "x.m_%s" % field.name
+            if field.type in products:
+                value = "*x.m_%s" % field.name
+            self.emit("if (x.m_%s) {" % field.name, 2)
+            self.emit(    "self().mix(1);", 3)
+            self.emit(    self.emit_value(field, value), 3)
+            self.emit("} else {", 2)
+            self.emit(    "self().mix(0);", 3)
+            self.emit("}", 2)
+        else:
+            self.emit(self.emit_value(field, "x.m_%s" % field.name), 2)
+
+
+# This class generates a visitor that copies the nodes into a position
+# independent image, see ASRImageWriter in src/libasr/serialization.cpp
+class ImageVisitorVisitor(ASDLVisitor):
+
+    def visitModule(self, mod):
+        self.emit("/" + "*"*78 + "/")
+        self.emit("// Image Visitor base class")
+        self.emit("")
+        self.emit("// Copies the visited node and its children into an image in which every")
+        self.emit("// pointer is an offset from the start of the image. image_<sum>() copies a")
+        self.emit("// child and returns its offset, image_<Node>(x, o) copies the fields of `x`")
+        self.emit("// into the (zeroed) copy of `x` at the offset `o`. The derived class")
+        self.emit("// implements the memory management and the pointer fields: allocate(),")
+        self.emit("// find_node(), add_node(), copy_value(), set_pointer(), set_symbol_ref(),")
+        self.emit("// set_symtab(), set_symtab_ref() and write_string().")
+        self.emit("template <class Derived>")
+        self.emit("class ImageBaseVisitor")
+        self.emit("{")
+        self.emit("private:")
+        self.emit(  "Derived& self() { return static_cast<Derived&>(*this); }", 1)
+        self.emit("public:")
+        self.emit(  "// Changes whenever the layout of the nodes changes, an image can only be", 1)
+        self.emit(  "// loaded by a compiler with the same layout", 1)
+        self.emit(  "static uint64_t layout_hash() {", 1)
+        self.emit(      "uint64_t h = sizeof(void*);", 2)
+        for dfn in mod.dfns:
+            if isinstance(dfn.value, asdl.Sum):
+                if is_simple_sum(dfn.value):
+                    continue
+                for cons in dfn.value.types:
+                    self.emit_layout(cons.name, cons.fields)
+            else:
+                self.emit_layout(dfn.name, dfn.value.fields)
+        self.emit(      "return h;", 2)
+        self.emit(  "}", 1)
+        self.emit(  "size_t image_%s(const %s_t &x) {" % (mod.name.lower(),
+            mod.name.lower()), 1)
+        self.emit(      "switch (x.type) {", 2)
+        for name in sums:
+            self.emit(          "case %sType::%s: return self().image_%s((const %s_t&)x);" \
+                % (mod.name.lower(), name, name, name), 3)
+        self.emit(      "}", 2)
+        self.emit(      'throw LFortranException("Unknown type in image_%s()");' \
+            % mod.name.lower(), 2)
+        self.emit(  "}", 1)
+        self.mod = mod
+        super(ImageVisitorVisitor, self).visitModule(mod)
+        self.emit("};")
+
+    def emit_layout(self, name, fields):
+        self.emit("h = h * 31 + sizeof(%s_t);" % name, 2)
+        for field in fields:
+            self.emit("h = h * 31 + offsetof(%s_t, m_%s);" % (name, field.name), 2)
+
+    def visitType(self, tp):
+        if not (isinstance(tp.value, asdl.Sum) and
+                is_simple_sum(tp.value)):
+            super(ImageVisitorVisitor, self).visitType(tp, tp.name)
+
+    def visitSum(self, sum, name):
+        self.emit("size_t image_%s(const %s_t &x) {" % (name, name), 1)
+        self.emit(    "size_t o;", 2)
+        self.emit(    "if (self().find_node(&x, o)) return o;", 2)
+        self.emit(    "switch (x.type) {", 2)
+        for cons in sum.types:
+            self.emit(        "case %sType::%s: {" % (name, cons.name), 3)
+            self.emit(            "o = self().allocate(sizeof(%s_t));" % cons.name, 4)
+            self.emit(            "self().add_node(&x, o);", 4)
+            self.emit(            "self().image_%s((const %s_t&)x, o);" \
+                % (cons.name, cons.name), 4)
+            self.emit(            "return o;", 4)
+            self.emit(        "}", 3)
+        self.emit(    "}", 2)
+        self.emit(    'throw LFortranException("Unknown type in image_%s()");' \
+            % name, 2)
+        self.emit("}", 1)
+        super(ImageVisitorVisitor, self).visitSum(sum, name)
+
+    def visitProduct(self, prod, name):
+        self.make_visitor(name, prod.fields, False)
+
+    def visitConstructor(self, cons, _):
+        self.make_visitor(cons.name, cons.fields, True)
+
+    def make_visitor(self, name, fields, cons):
+        self.emit("void image_%s(const %s_t &x, size_t o) {" % (name, name), 1)
+        if cons:
+            self.emit("self().copy_value(o + offsetof(%s_t, base.base.type), x.base.base.type);" % name, 2)
+            self.emit("self().copy_value(o + offsetof(%s_t, base.base.loc), x.base.base.loc);" % name, 2)
+            self.emit("self().copy_value(o + offsetof(%s_t, base.type), x.base.type);" % name, 2)
+        else:
+            self.emit("self().copy_value(o + offsetof(%s_t, loc), x.loc);" % name, 2)
+        self.name = name
+        for field in fields:
+            self.visitField(field)
+        self.emit("}", 1)
+
+    def emit_value(self, field, slot, value):
+        # Emits the copy of one value of the field into the `slot`. A product
+        # is copied in place, everything else is a pointer.
+        if field.type == "symbol":
+            return "self().set_symbol_ref(%s, %s);" % (slot, value)
+        elif field.type in products:
+            return "self().image_%s(%s, %s);" % (field.type, value, slot)
+        elif field.type in ["identifier", "string"]:
+            return "self().set_pointer(%s, self().write_string(%s));" \
+                % (slot, value)
+        elif field.type == "node":
+            return "self().set_pointer(%s, self().image_%s(*%s));" \
+                % (slot, self.mod.name.lower(), value)
+        else:
+            return "self().set_pointer(%s, self().image_%s(*%s));" \
+                % (slot, field.type, value)
+
+    def visitField(self, field):
+        slot = "o + offsetof(%s_t, m_%s)" % (self.name, field.name)
+        value = "x.m_%s" % field.name
+        if field.type == "symbol_table":
+            assert not field.seq and not field.opt
+            if field.name == "parent_symtab":
+                self.emit("self().set_symtab_ref(%s, %s);" % (slot, value), 2)
+            else:
+                self.emit("self().set_symtab(%s, *%s, o);" % (slot, value), 2)
+            return
+        if field.seq:
+            elem = field.type + "_t"
+            if field.type in ["identifier", "string"]:
+                elem = "char*"
+            elif field.type == "node":
+                elem = self.mod.name.lower() + "_t*"
+            elif field.type not in products:
+                elem = elem + "*"
+            self.emit("if (x.n_%s > 0) {" % field.name, 2)
+            self.emit(    "size_t a = self().allocate(x.n_%s * sizeof(%s));" \
+                % (field.name, elem), 3)
+            self.emit(    "self().set_pointer(%s, a);" % slot, 3)
+            self.emit(    "for (size_t i=0; i<x.n_%s; i++) {" % field.name, 3)
+            self.emit(        self.emit_value(field, "a + i*sizeof(%s)" % elem,
+                "x.m_%s[i]" % field.name), 4)
+            self.emit(    "}", 3)
+            self.emit("}", 2)
+            self.emit("self().copy_value(o + offsetof(%s_t, n_%s), x.n_%s);" \
+                % (self.name, field.name, field.name), 2)
+        elif field.type in ["int", "bool", "float"] or \
+                field.type in self.data.simple_types:
+            self.emit("self().copy_value(%s, %s);" % (slot, value), 2)
+        elif field.type in products and not field.opt:
+            self.emit(self.emit_value(field, slot, value), 2)
+        elif field.type in products:
+            self.emit("if (%s) {" % value, 2)
+            self.emit(    "size_t p = self().allocate(sizeof(%s_t));" % field.type, 3)
+            self.emit(    "self().set_pointer(%s, p);" % slot, 3)
+            self.emit(    self.emit_value(field, "p", "*" + value), 3)
+            self.emit("}", 2)
+        elif self.name == "ExternalSymbol" and field.name == "external":
+            self.emit("// The symbol of another module, see fix_external_symbols()", 2)
+        else:
+            self.emit("if (%s) {" % value, 2)
+            self.emit(    self.emit_value(field, slot, value), 3)
+            self.emit("}", 2)
+
+
 # This class generates a visitor that prints the tree structure of AST/ASR
 class TreeVisitorVisitor(ASDLVisitor):
 
@@ -1952,6 +2488,12 @@ HEAD = r"""#ifndef LFORTRAN_%(MOD2)s_H
 
 // Generated by grammar/asdl_cpp.py
 
+#include <bitset>
+#include <cstddef>
+#include <cstring>
+#include <map>
+#include <vector>
+
 #include <libasr/alloc.h>
 #include <libasr/location.h>
 #include <libasr/colors.h>
@@ -2009,7 +2551,7 @@ FOOT = r"""} // namespace LFortran::%(MOD)s
 
 visitors = [ASTNodeVisitor0, ASTNodeVisitor1, ASTNodeVisitor,
         ASTVisitorVisitor1, ASTVisitorVisitor1b, ASTVisitorVisitor2,
-        ASTWalkVisitorVisitor, TreeVisitorVisitor, PickleVisitorVisitor,
+        ASTWalkVisitorVisitor, IterativeWalkVisitorVisitor, TreeVisitorVisitor, PickleVisitorVisitor,
         SerializationVisitorVisitor, DeserializationVisitorVisitor]
 
 
@@ -2063,6 +2605,14 @@ def main(argv):
             fp.write("\n\n")
             ExprValueVisitor(fp, data).visit(mod)
             fp.write("\n\n")
+            StringWalkVisitorVisitor(fp, data).visit(mod)
+            fp.write("\n\n")
+            SubtreeKindsVisitorVisitor(fp, data).visit(mod)
+            fp.write("\n\n")
+            StructuralHashVisitorVisitor(fp, data).visit(mod)
+            fp.write("\n\n")
+            ImageVisitorVisitor(fp, data).visit(mod)
+            fp.write("\n\n")
             fp.write(FOOT % subs)
     finally:
         fp.close()
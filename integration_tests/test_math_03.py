@@ -0,0 +1,32 @@
+from ltypes import i32, i64, f64, c64
+from math import lcm, comb, trunc
+
+def test_lcm():
+    # lcm() -> gcd() -> mod() -> floor()
+    assert lcm(4, 6) == 12
+    assert lcm(-3, 5) == 15
+    assert lcm(0, 7) == 0
+
+def test_comb():
+    # comb() -> factorial(), floor()
+    assert comb(5, 2) == 10
+    assert comb(6, 6) == 1
+
+def test_trunc():
+    # The overloads of trunc() -> floor(), ceil()
+    x: f64
+    x = 2.7
+    assert trunc(x) == 2
+    x = -2.7
+    assert trunc(x) == -2
+
+def test_abs():
+    # The overload of abs() for c64 -> _lfortran_zaimag()
+    z: c64
+    z = complex(3.0, 4.0)
+    assert abs(z) == 5.0
+
+test_lcm()
+test_comb()
+test_trunc()
+test_abs()
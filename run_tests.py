@@ -1,11 +1,26 @@
 #!/usr/bin/env python
 
 import argparse
+import json
 import os
 
 import toml
 
-from compiler_tester.tester import run_test, color, style, fg
+from compiler_tester.tester import run_test, bname, color, style, fg, RunException
+
+def check_same_output(basename1, cmd1, basename2, cmd2, filename):
+    """
+    Checks that the reference results of two commands have the same output.
+    """
+    results = []
+    for basename, cmd in [(basename1, cmd1), (basename2, cmd2)]:
+        jr = os.path.join("tests", "reference",
+                bname(basename, cmd, filename) + ".json")
+        d = json.load(open(jr))
+        results.append((d["returncode"], d["stdout_hash"], d["stderr_hash"]))
+    if results[0] != results[1]:
+        raise RunException("The output of '%s' and '%s' differs"
+                % (basename1, basename2))
 
 def main():
     parser = argparse.ArgumentParser(description="LPython Test Suite")
@@ -44,6 +59,8 @@ def main():
         ast_openmp = test.get("ast_openmp", False)
         ast_new = test.get("ast_new", False)
         asr = test.get("asr", False)
+        asr_jobs = test.get("asr_jobs", False)
+        asr_fast = test.get("asr_fast", False)
         asr_preprocess = test.get("asr_preprocess", False)
         asr_indent = test.get("asr_indent", False)
         mod_to_asr = test.get("mod_to_asr", False)
@@ -75,6 +92,20 @@ def main():
             run_test("asr", "lpython --show-asr --no-color {infile} -o {outfile}",
                     filename, update_reference, extra_args)
 
+        if asr_jobs:
+            # The ASR must not depend on how the modules and the functions
+            # are scheduled on the threads
+            cmd = "lpython --show-asr --no-color {infile} -o {outfile}"
+            cmd_jobs = "lpython --show-asr -j 4 --no-color {infile} -o {outfile}"
+            run_test("asr", cmd, filename, update_reference, extra_args)
+            run_test("asr_jobs", cmd_jobs, filename, update_reference,
+                    extra_args)
+            check_same_output("asr", cmd, "asr_jobs", cmd_jobs, filename)
+
+        if asr_fast:
+            run_test("asr_fast", "lpython --fast --show-asr --no-color {infile} -o {outfile}",
+                    filename, update_reference, extra_args)
+
         if pass_ is not None:
             cmd = "lpython --pass=" + pass_ + " --show-asr --no-color {infile} -o {outfile}"
             run_test("pass_{}".format(pass_), cmd,
@@ -1,5 +1,9 @@
 #include <chrono>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <memory>
+#include <sstream>
 #include <stdlib.h>
 #include <cstdlib>
 
@@ -22,6 +26,7 @@
 #include <libasr/modfile.h>
 #include <libasr/config.h>
 #include <libasr/string_utils.h>
+#include <libasr/source_manager.h>
 #include <lpython/utils.h>
 #include <lpython/python_serialization.h>
 #include <lpython/parser/tokenizer.h>
@@ -70,6 +75,32 @@ std::string get_kokkos_dir()
 
 #endif
 
+// The initial chunk size of an Allocator for `input_size` bytes of source,
+// so that large inputs do not need many chunks. The unused part of a chunk
+// is never touched and so does not count towards the resident memory.
+size_t arena_size(size_t input_size) {
+    return std::max<size_t>(4*1024,
+        std::min<size_t>(16*input_size, 256*1024*1024));
+}
+
+// Converts the AST to ASR in `al` and frees the Allocator `ast_al` of the
+// AST, which is not needed anymore, after copying the strings the ASR
+// shares with it
+LFortran::Result<LFortran::ASR::TranslationUnit_t*> ast_to_asr(Allocator &al,
+        std::unique_ptr<Allocator> &ast_al, LFortran::LPython::AST::ast_t &ast,
+        LFortran::diag::Diagnostics &diagnostics,
+        CompilerOptions &compiler_options, const std::string &infile)
+{
+    LFortran::Result<LFortran::ASR::TranslationUnit_t*>
+        r = LFortran::LPython::python_ast_to_asr(al, ast, diagnostics,
+            compiler_options, true, infile);
+    if (r.ok) {
+        LFortran::ASRUtils::copy_strings_from(al, *r.result, *ast_al);
+    }
+    ast_al.reset();
+    return r;
+}
+
 int emit_tokens(const std::string &infile, bool line_numbers, const CompilerOptions &compiler_options)
 {
     std::string input = LFortran::read_file(infile);
@@ -106,15 +137,15 @@ int emit_ast(const std::string &infile,
     const std::string &runtime_library_dir,
     CompilerOptions &compiler_options)
 {
-    Allocator al(4*1024);
+    std::string_view input;
+    LFortran::get_source_manager().get_file(infile, input);
+    Allocator al(arena_size(input.size()));
     LFortran::diag::Diagnostics diagnostics;
     LFortran::Result<LFortran::LPython::AST::ast_t*> r = parse_python_file(
         al, runtime_library_dir, infile, diagnostics, compiler_options.new_parser);
     if (diagnostics.diagnostics.size() > 0) {
         LFortran::LocationManager lm;
         lm.in_filename = infile;
-        // TODO: only read this once, and pass it as an argument to parse_python_file()
-        std::string input = LFortran::read_file(infile);
         lm.init_simple(input);
         std::cerr << diagnostics.render(input, lm, compiler_options);
     }
@@ -139,14 +170,17 @@ int emit_asr(const std::string &infile,
     const std::string &runtime_library_dir,
     bool with_intrinsic_modules, CompilerOptions &compiler_options)
 {
-    Allocator al(4*1024);
     LFortran::diag::Diagnostics diagnostics;
     LFortran::LocationManager lm;
     lm.in_filename = infile;
-    std::string input = LFortran::read_file(infile);
+    std::string_view input;
+    LFortran::get_source_manager().get_file(infile, input);
     lm.init_simple(input);
+    Allocator al(arena_size(input.size()));
+    std::unique_ptr<Allocator> ast_al
+        = std::make_unique<Allocator>(arena_size(input.size()));
     LFortran::Result<LFortran::LPython::AST::ast_t*> r1 = parse_python_file(
-        al, runtime_library_dir, infile, diagnostics, compiler_options.new_parser);
+        *ast_al, runtime_library_dir, infile, diagnostics, compiler_options.new_parser);
     std::cerr << diagnostics.render(input, lm, compiler_options);
     if (!r1.ok) {
         return 1;
@@ -155,8 +189,8 @@ int emit_asr(const std::string &infile,
 
     diagnostics.diagnostics.clear();
     LFortran::Result<LFortran::ASR::TranslationUnit_t*>
-        r = LFortran::LPython::python_ast_to_asr(al, *ast, diagnostics, true,
-            compiler_options.disable_main, compiler_options.symtab_only, infile);
+        r = ast_to_asr(al, ast_al, *ast, diagnostics,
+            compiler_options, infile);
     std::cerr << diagnostics.render(input, lm, compiler_options);
     if (!r.ok) {
         LFORTRAN_ASSERT(diagnostics.has_error())
@@ -179,14 +213,17 @@ int emit_cpp(const std::string &infile,
     const std::string &runtime_library_dir,
     CompilerOptions &compiler_options)
 {
-    Allocator al(4*1024);
     LFortran::diag::Diagnostics diagnostics;
     LFortran::LocationManager lm;
     lm.in_filename = infile;
-    std::string input = LFortran::read_file(infile);
+    std::string_view input;
+    LFortran::get_source_manager().get_file(infile, input);
     lm.init_simple(input);
+    Allocator al(arena_size(input.size()));
+    std::unique_ptr<Allocator> ast_al
+        = std::make_unique<Allocator>(arena_size(input.size()));
     LFortran::Result<LFortran::LPython::AST::ast_t*> r = parse_python_file(
-        al, runtime_library_dir, infile, diagnostics, compiler_options.new_parser);
+        *ast_al, runtime_library_dir, infile, diagnostics, compiler_options.new_parser);
     std::cerr << diagnostics.render(input, lm, compiler_options);
     if (!r.ok) {
         return 1;
@@ -195,8 +232,8 @@ int emit_cpp(const std::string &infile,
 
     diagnostics.diagnostics.clear();
     LFortran::Result<LFortran::ASR::TranslationUnit_t*>
-        r1 = LFortran::LPython::python_ast_to_asr(al, *ast, diagnostics, true,
-            compiler_options.disable_main, compiler_options.symtab_only, infile);
+        r1 = ast_to_asr(al, ast_al, *ast, diagnostics,
+            compiler_options, infile);
     std::cerr << diagnostics.render(input, lm, compiler_options);
     if (!r1.ok) {
         LFORTRAN_ASSERT(diagnostics.has_error())
@@ -220,14 +257,17 @@ int emit_c(const std::string &infile,
     const std::string &runtime_library_dir,
     CompilerOptions &compiler_options)
 {
-    Allocator al(4*1024);
     LFortran::diag::Diagnostics diagnostics;
     LFortran::LocationManager lm;
     lm.in_filename = infile;
-    std::string input = LFortran::read_file(infile);
+    std::string_view input;
+    LFortran::get_source_manager().get_file(infile, input);
     lm.init_simple(input);
+    Allocator al(arena_size(input.size()));
+    std::unique_ptr<Allocator> ast_al
+        = std::make_unique<Allocator>(arena_size(input.size()));
     LFortran::Result<LFortran::LPython::AST::ast_t*> r = parse_python_file(
-        al, runtime_library_dir, infile, diagnostics, compiler_options.new_parser);
+        *ast_al, runtime_library_dir, infile, diagnostics, compiler_options.new_parser);
     std::cerr << diagnostics.render(input, lm, compiler_options);
     if (!r.ok) {
         return 1;
@@ -236,8 +276,8 @@ int emit_c(const std::string &infile,
 
     diagnostics.diagnostics.clear();
     LFortran::Result<LFortran::ASR::TranslationUnit_t*>
-        r1 = LFortran::LPython::python_ast_to_asr(al, *ast, diagnostics, true,
-            compiler_options.disable_main, compiler_options.symtab_only, infile);
+        r1 = ast_to_asr(al, ast_al, *ast, diagnostics,
+            compiler_options, infile);
     std::cerr << diagnostics.render(input, lm, compiler_options);
     if (!r1.ok) {
         LFORTRAN_ASSERT(diagnostics.has_error())
@@ -264,14 +304,17 @@ int emit_llvm(const std::string &infile,
     LCompilers::PassManager& pass_manager,
     CompilerOptions &compiler_options)
 {
-    Allocator al(4*1024);
     LFortran::diag::Diagnostics diagnostics;
     LFortran::LocationManager lm;
     lm.in_filename = infile;
-    std::string input = LFortran::read_file(infile);
+    std::string_view input;
+    LFortran::get_source_manager().get_file(infile, input);
     lm.init_simple(input);
+    Allocator al(arena_size(input.size()));
+    std::unique_ptr<Allocator> ast_al
+        = std::make_unique<Allocator>(arena_size(input.size()));
     LFortran::Result<LFortran::LPython::AST::ast_t*> r = parse_python_file(
-        al, runtime_library_dir, infile, diagnostics, compiler_options.new_parser);
+        *ast_al, runtime_library_dir, infile, diagnostics, compiler_options.new_parser);
     std::cerr << diagnostics.render(input, lm, compiler_options);
     if (!r.ok) {
         return 1;
@@ -281,8 +324,8 @@ int emit_llvm(const std::string &infile,
     LFortran::LPython::AST::ast_t* ast = r.result;
     diagnostics.diagnostics.clear();
     LFortran::Result<LFortran::ASR::TranslationUnit_t*>
-        r1 = LFortran::LPython::python_ast_to_asr(al, *ast, diagnostics, true,
-            compiler_options.disable_main, compiler_options.symtab_only, infile);
+        r1 = ast_to_asr(al, ast_al, *ast, diagnostics,
+            compiler_options, infile);
     std::cerr << diagnostics.render(input, lm, compiler_options);
     if (!r1.ok) {
         LFORTRAN_ASSERT(diagnostics.has_error())
@@ -304,11 +347,94 @@ int emit_llvm(const std::string &infile,
     return 0;
 }
 
-void print_time_report(std::vector<std::pair<std::string, double>> &times, bool time_report) {
+void print_time_report(std::vector<std::pair<std::string, double>> &times,
+        const std::vector<LCompilers::PassReport> &passes, bool time_report) {
     if (time_report) {
         for (auto &stage :times) {
             std::cout << stage.first << ": " << stage.second << "ms" << std::endl;
         }
+        // The reports with an empty name are the state before the passes
+        for (size_t i = 1; i < passes.size(); i++) {
+            if (passes[i].name.empty()) continue;
+            std::cout << "ASR pass " << passes[i].name << ": "
+                << passes[i].time << "ms, "
+                << passes[i].memory.allocated - passes[i-1].memory.allocated
+                << " bytes allocated" << std::endl;
+        }
+        auto &stats = LFortran::ASRUtils::generic_procedure_cache_stats;
+        uint64_t hits = stats.hits, misses = stats.misses;
+        if (hits + misses > 0) {
+            std::cout << "Overload resolution cache: " << hits << " hits, "
+                << misses << " misses (" << 100. * hits / (hits + misses)
+                << "% hit rate)" << std::endl;
+        }
+    }
+}
+
+// Saves the times of the compiler stages and of the ASR passes as JSON to
+// `filename`, unless it is empty. The numbers of nodes are only known if the
+// PassManager counted them (`count_pass_nodes`).
+void save_time_report_json(std::vector<std::pair<std::string, double>> &times,
+        const std::vector<LCompilers::PassReport> &passes,
+        const std::string &filename) {
+    if (filename.empty()) return;
+    std::ofstream out(filename);
+    out << "{" << std::endl;
+    out << "    \"stages\": [";
+    for (size_t i = 0; i < times.size(); i++) {
+        out << (i > 0 ? "," : "") << std::endl;
+        out << "        {\"name\": \"" << times[i].first
+            << "\", \"time_ms\": " << times[i].second << "}";
+    }
+    out << std::endl << "    ]," << std::endl;
+    out << "    \"passes\": [";
+    bool first = true;
+    for (size_t i = 1; i < passes.size(); i++) {
+        if (passes[i].name.empty()) continue;
+        const LCompilers::PassReport &before = passes[i-1], &after = passes[i];
+        out << (first ? "" : ",") << std::endl;
+        first = false;
+        out << "        {\"name\": \"" << after.name
+            << "\", \"time_ms\": " << after.time
+            << ", \"allocated_bytes\": "
+            << after.memory.allocated - before.memory.allocated
+            << ", \"new_chunks\": "
+            << after.memory.chunks - before.memory.chunks
+            << ", \"nodes\": " << after.nodes
+            << ", \"nodes_added\": "
+            << (int64_t)after.nodes - (int64_t)before.nodes << "}";
+    }
+    out << std::endl << "    ]" << std::endl;
+    out << "}" << std::endl;
+    if (!out) {
+        std::cerr << "The time report could not be saved to '" << filename
+            << "'." << std::endl;
+    }
+}
+
+// The memory used by a compiler phase, see print_memory_report()
+struct PhaseMemory {
+    std::string name;
+    LFortran::MemoryUsage before, after;
+};
+
+std::string format_bytes(size_t bytes) {
+    std::stringstream out;
+    out << std::fixed << std::setprecision(2) << bytes / (1024.*1024) << " MB";
+    return out.str();
+}
+
+void print_memory_report(std::vector<PhaseMemory> &phases, bool mem_report) {
+    if (mem_report) {
+        for (auto &phase : phases) {
+            std::cout << phase.name << ": "
+                << format_bytes(phase.after.allocated - phase.before.allocated)
+                << " allocated in "
+                << phase.after.chunks - phase.before.chunks
+                << " new chunks, Vec regrowth waste "
+                << format_bytes(phase.after.wasted) << ", peak RSS "
+                << format_bytes(phase.after.peak_rss) << std::endl;
+        }
     }
 }
 
@@ -318,42 +444,59 @@ int compile_python_to_object_file(
         const std::string &runtime_library_dir,
         LCompilers::PassManager& pass_manager,
         CompilerOptions &compiler_options,
-        bool time_report)
+        bool time_report, const std::string &time_report_json,
+        bool mem_report)
 {
-    Allocator al(4*1024);
+    std::vector<PhaseMemory> memory;
     LFortran::diag::Diagnostics diagnostics;
     LFortran::LocationManager lm;
     lm.in_filename = infile;
     std::vector<std::pair<std::string, double>>times;
     auto file_reading_start = std::chrono::high_resolution_clock::now();
-    std::string input = LFortran::read_file(infile);
+    std::string_view input;
+    LFortran::get_source_manager().get_file(infile, input);
     auto file_reading_end = std::chrono::high_resolution_clock::now();
     times.push_back(std::make_pair("File reading", std::chrono::duration<double, std::milli>(file_reading_end - file_reading_start).count()));
     lm.init_simple(input);
+    Allocator al(arena_size(input.size()));
+    std::unique_ptr<Allocator> ast_al
+        = std::make_unique<Allocator>(arena_size(input.size()));
+    LFortran::MemoryUsage memory_start = LFortran::get_memory_usage(*ast_al);
     auto parsing_start = std::chrono::high_resolution_clock::now();
     LFortran::Result<LFortran::LPython::AST::ast_t*> r = parse_python_file(
-        al, runtime_library_dir, infile, diagnostics, compiler_options.new_parser);
+        *ast_al, runtime_library_dir, infile, diagnostics, compiler_options.new_parser);
     auto parsing_end = std::chrono::high_resolution_clock::now();
     times.push_back(std::make_pair("Parsing", std::chrono::duration<double, std::milli>(parsing_end - parsing_start).count()));
+    memory.push_back({"Parsing", memory_start,
+        LFortran::get_memory_usage(*ast_al)});
     std::cerr << diagnostics.render(input, lm, compiler_options);
     if (!r.ok) {
-        print_time_report(times, time_report);
+        print_time_report(times, pass_manager.pass_reports, time_report);
+        save_time_report_json(times, pass_manager.pass_reports,
+            time_report_json);
+        print_memory_report(memory, mem_report);
         return 1;
     }
 
     // Src -> AST -> ASR
     LFortran::LPython::AST::ast_t* ast = r.result;
     diagnostics.diagnostics.clear();
+    LFortran::MemoryUsage ast_to_asr_memory = LFortran::get_memory_usage(al);
     auto ast_to_asr_start = std::chrono::high_resolution_clock::now();
     LFortran::Result<LFortran::ASR::TranslationUnit_t*>
-        r1 = LFortran::LPython::python_ast_to_asr(al, *ast, diagnostics, true,
-            compiler_options.disable_main, compiler_options.symtab_only, infile);
+        r1 = ast_to_asr(al, ast_al, *ast, diagnostics,
+            compiler_options, infile);
     auto ast_to_asr_end = std::chrono::high_resolution_clock::now();
     times.push_back(std::make_pair("AST to ASR", std::chrono::duration<double, std::milli>(ast_to_asr_end - ast_to_asr_start).count()));
+    memory.push_back({"AST to ASR", ast_to_asr_memory,
+        LFortran::get_memory_usage(al)});
     std::cerr << diagnostics.render(input, lm, compiler_options);
     if (!r1.ok) {
         LFORTRAN_ASSERT(diagnostics.has_error())
-        print_time_report(times, time_report);
+        print_time_report(times, pass_manager.pass_reports, time_report);
+        save_time_report_json(times, pass_manager.pass_reports,
+            time_report_json);
+        print_memory_report(memory, mem_report);
         return 2;
     }
     LFortran::ASR::TranslationUnit_t* asr = r1.result;
@@ -363,15 +506,36 @@ int compile_python_to_object_file(
     LFortran::PythonCompiler fe(compiler_options);
     LFortran::LLVMEvaluator e(compiler_options.target);
     std::unique_ptr<LFortran::LLVMModule> m;
+    // The ASR passes and the LLVM backend allocate from `fe`
+    LFortran::MemoryUsage asr_to_llvm_memory
+        = LFortran::get_memory_usage(fe.get_allocator());
+    pass_manager.report_passes = time_report || !time_report_json.empty()
+        || mem_report;
+    // Walking the whole ASR after every pass is slow, only done for the JSON
+    pass_manager.count_pass_nodes = !time_report_json.empty();
+    pass_manager.pass_reports.clear();
+    pass_manager.report_time = 0;
     auto asr_to_llvm_start = std::chrono::high_resolution_clock::now();
     LFortran::Result<std::unique_ptr<LFortran::LLVMModule>>
         res = fe.get_llvm3(*asr, pass_manager, diagnostics);
     auto asr_to_llvm_end = std::chrono::high_resolution_clock::now();
-    times.push_back(std::make_pair("ASR to LLVM", std::chrono::duration<double, std::milli>(asr_to_llvm_end - asr_to_llvm_start).count()));
+    // Without the time spent on the pass reports
+    times.push_back(std::make_pair("ASR to LLVM", std::chrono::duration<double, std::milli>(asr_to_llvm_end - asr_to_llvm_start).count()
+        - pass_manager.report_time));
+    auto &passes = pass_manager.pass_reports;
+    for (size_t i = 1; i < passes.size(); i++) {
+        memory.push_back({"ASR pass " + passes[i].name,
+            passes[i-1].memory, passes[i].memory});
+    }
+    memory.push_back({"ASR to LLVM", asr_to_llvm_memory,
+        LFortran::get_memory_usage(fe.get_allocator())});
     std::cerr << diagnostics.render(input, lm, compiler_options);
     if (!res.ok) {
         LFORTRAN_ASSERT(diagnostics.has_error())
-        print_time_report(times, time_report);
+        print_time_report(times, pass_manager.pass_reports, time_report);
+        save_time_report_json(times, pass_manager.pass_reports,
+            time_report_json);
+        print_memory_report(memory, mem_report);
         return 3;
     }
     m = std::move(res.result);
@@ -379,12 +543,54 @@ int compile_python_to_object_file(
     e.save_object_file(*(m->m_m), outfile);
     auto llvm_end = std::chrono::high_resolution_clock::now();
     times.push_back(std::make_pair("LLVM to binary", std::chrono::duration<double, std::milli>(llvm_end - llvm_start).count()));
-    print_time_report(times, time_report);
+    // LLVM allocates its own memory, not from an Allocator, so there is no
+    // memory report for the last stage
+    print_time_report(times, pass_manager.pass_reports, time_report);
+    save_time_report_json(times, pass_manager.pass_reports, time_report_json);
+    print_memory_report(memory, mem_report);
     return 0;
 }
 
 #endif
 
+int save_module_cache(const std::vector<std::string> &modules,
+    const std::string &runtime_library_dir,
+    CompilerOptions &compiler_options)
+{
+    // A module that fails does not stop the others, it is compiled from
+    // source when imported
+    int err = 0;
+    for (auto &module_name : modules) {
+        std::string infile = runtime_library_dir + "/" + module_name + ".py";
+        std::string_view input;
+        if (!LFortran::get_source_manager().get_file(infile, input)) {
+            // Out of tree builds do not have the runtime modules next to
+            // the runtime library, they are compiled from source then
+            std::cerr << "The runtime module '" << infile
+                << "' was not found, its module cache was not saved." << std::endl;
+            continue;
+        }
+        LFortran::diag::Diagnostics diagnostics;
+        LFortran::LocationManager lm;
+        lm.in_filename = infile;
+        lm.init_simple(input);
+        bool saved = false;
+        try {
+            saved = LFortran::LPython::save_module_cache(module_name,
+                runtime_library_dir, diagnostics, compiler_options).ok;
+        } catch (const LFortran::LFortranException &e) {
+            std::cerr << e.msg() << std::endl;
+        }
+        std::cerr << diagnostics.render(input, lm, compiler_options);
+        if (!saved) {
+            std::cerr << "The module cache of '" << module_name
+                << "' was not saved." << std::endl;
+            err = 1;
+        }
+    }
+    return err;
+}
+
 void do_print_rtlib_header_dir() {
     std::string rtlib_header_dir = LFortran::get_runtime_library_header_dir();
     std::cout << rtlib_header_dir << std::endl;
@@ -590,6 +796,8 @@ int main(int argc, char *argv[])
         bool show_llvm = false;
         bool show_asm = false;
         bool time_report = false;
+        std::string time_report_json;
+        bool mem_report = false;
         bool static_link = false;
         std::string arg_backend = "llvm";
         std::string arg_kernel_f;
@@ -611,6 +819,8 @@ int main(int argc, char *argv[])
 
         std::string arg_lsp_filename;
 
+        std::vector<std::string> arg_save_module_cache;
+
         CompilerOptions compiler_options;
         LCompilers::PassManager lpython_pass_manager;
 
@@ -651,7 +861,9 @@ int main(int argc, char *argv[])
         app.add_option("--pass", arg_pass, "Apply the ASR pass and show ASR (implies --show-asr)");
         app.add_flag("--disable-main", compiler_options.disable_main, "Do not generate any code for the `main` function");
         app.add_flag("--symtab-only", compiler_options.symtab_only, "Only create symbol tables in ASR (skip executable stmt)");
-        app.add_flag("--time-report", time_report, "Show compilation time report");
+        app.add_flag("--time-report", time_report, "Show compilation time report (only when compiling with the LLVM backend)");
+        app.add_option("--time-report-json", time_report_json, "Save the compilation time report, with the ASR passes, as JSON to the given file (only when compiling with the LLVM backend)");
+        app.add_flag("--mem-report", mem_report, "Show compilation memory report (only when compiling with the LLVM backend)");
         app.add_flag("--static", static_link, "Create a static executable");
         app.add_flag("--no-warnings", compiler_options.no_warnings, "Turn off all warnings");
         app.add_flag("--no-error-banner", compiler_options.no_error_banner, "Turn off error banner");
@@ -661,6 +873,10 @@ int main(int argc, char *argv[])
         app.add_option("--target", compiler_options.target, "Generate code for the given target")->capture_default_str();
         app.add_flag("--print-targets", print_targets, "Print the registered targets");
         app.add_flag("--get-rtlib-header-dir", print_rtlib_header_dir, "Print the path to the runtime library header file");
+        app.add_option("--module-cache-dir", compiler_options.module_cache_dir, "Cache the ASR of the imported modules in the given directory");
+        app.add_flag("--no-module-cache", compiler_options.no_module_cache, "Do not load the ASR of the imported modules from the module cache");
+        app.add_option("-j,--jobs", compiler_options.jobs, "Number of threads used to load the imported modules and to lower the function bodies")->capture_default_str();
+        app.add_option("--save-module-cache", arg_save_module_cache, "Precompile the given runtime modules and save their ASR into the runtime library directory (or the --module-cache-dir)");
 
         if( compiler_options.fast ) {
             lpython_pass_manager.use_optimization_passes();
@@ -738,6 +954,11 @@ int main(int argc, char *argv[])
 
         compiler_options.use_colors = !arg_no_color;
 
+        if (arg_save_module_cache.size() > 0) {
+            return save_module_cache(arg_save_module_cache, runtime_library_dir,
+                compiler_options);
+        }
+
         // if (fmt) {
         //     return format(arg_fmt_file, arg_fmt_inplace, !arg_fmt_no_color,
         //         arg_fmt_indent, arg_fmt_indent_unit, compiler_options);
@@ -820,6 +1041,12 @@ int main(int argc, char *argv[])
         // }
 
         lpython_pass_manager.parse_pass_arg(arg_pass);
+        if (mem_report && (show_tokens || show_ast || show_asr || show_cpp
+                || show_c || show_llvm || show_asm || arg_S
+                || backend != Backend::llvm || !endswith(arg_file, ".py"))) {
+            std::cerr << "The --mem-report option is only supported when compiling a Python file with the LLVM backend." << std::endl;
+            return 1;
+        }
         if (show_tokens) {
             return emit_tokens(arg_file, true, compiler_options);
         }
@@ -864,7 +1091,7 @@ int main(int argc, char *argv[])
         if (arg_c) {
             if (backend == Backend::llvm) {
 #ifdef HAVE_LFORTRAN_LLVM
-                return compile_python_to_object_file(arg_file, outfile, runtime_library_dir, lpython_pass_manager, compiler_options, time_report);
+                return compile_python_to_object_file(arg_file, outfile, runtime_library_dir, lpython_pass_manager, compiler_options, time_report, time_report_json, mem_report);
 #else
                 std::cerr << "The -c option requires the LLVM backend to be enabled. Recompile with `WITH_LLVM=yes`." << std::endl;
                 return 1;
@@ -880,7 +1107,7 @@ int main(int argc, char *argv[])
             int err;
             if (backend == Backend::llvm) {
 #ifdef HAVE_LFORTRAN_LLVM
-                err = compile_python_to_object_file(arg_file, tmp_o, runtime_library_dir, lpython_pass_manager, compiler_options, time_report);
+                err = compile_python_to_object_file(arg_file, tmp_o, runtime_library_dir, lpython_pass_manager, compiler_options, time_report, time_report_json, mem_report);
 #else
                 std::cerr << "Compiling Python files to object files requires the LLVM backend to be enabled. Recompile with `WITH_LLVM=yes`." << std::endl;
                 return 1;
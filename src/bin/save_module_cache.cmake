@@ -0,0 +1,20 @@
+# Precompiles the ASR of the runtime Python modules, see src/bin/CMakeLists.txt.
+# A module that cannot be precompiled only gives a warning: without its cache
+# it is compiled from source whenever it is imported.
+#
+# Arguments: LPYTHON, RUNTIME_LIBRARY_DIR, CACHE_DIR and MODULES (separated
+# by commas)
+
+string(REPLACE "," ";" MODULES "${MODULES}")
+execute_process(
+    COMMAND ${CMAKE_COMMAND} -E env
+        LFORTRAN_RUNTIME_LIBRARY_DIR=${RUNTIME_LIBRARY_DIR}
+        ${LPYTHON} --new-parser
+        --module-cache-dir ${CACHE_DIR}
+        --save-module-cache ${MODULES}
+    RESULT_VARIABLE result
+)
+if (NOT result EQUAL 0)
+    message(WARNING "The module cache of some runtime modules was not saved "
+        "(lpython exited with: ${result}), they will be compiled from source")
+endif()
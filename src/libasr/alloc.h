@@ -3,6 +3,7 @@
 
 #include <algorithm>
 #include <cstdlib>
+#include <cstring>
 #include <new>
 #include <stdexcept>
 #include <vector>
@@ -20,7 +21,30 @@ class Allocator
     void *start;
     size_t current_pos;
     size_t size;
+    size_t reserved; // The size of all chunks
     std::vector<void*> blocks;
+    std::vector<size_t> block_sizes; // The size of each chunk in `blocks`
+    // The bytes used of each chunk in `blocks`, except for the current one
+    // (`start`, at index `current_block`), which uses size_current()
+    std::vector<size_t> block_used;
+    size_t current_block = 0;
+    size_t allocated_before = 0; // The bytes allocated from previous chunks
+    // Released blocks by size class, see release()
+    struct FreeBlock {
+        FreeBlock *next;
+        size_t size;
+    };
+    static const size_t n_size_classes = 64;
+    FreeBlock *free_blocks[n_size_classes] = {};
+    size_t released = 0; // The size of all blocks in `free_blocks`
+
+    // The size class of a block of `s` bytes, the blocks of class `c` have
+    // at least 2^c bytes
+    static size_t size_class(size_t s) {
+        size_t c = 0;
+        while (s >>= 1) c++;
+        return c;
+    }
 public:
     Allocator(size_t s) {
         s += ALIGNMENT;
@@ -29,7 +53,10 @@ public:
         current_pos = (size_t)start;
         current_pos = align(current_pos);
         size = s;
+        reserved = s;
         blocks.push_back(start);
+        block_sizes.push_back(s);
+        block_used.push_back(0);
     }
     Allocator() = delete;
     Allocator(const Allocator&) = delete;
@@ -38,7 +65,17 @@ public:
     Allocator& operator=(const Allocator&&) = delete;
     ~Allocator() {
         for (size_t i = 0; i < blocks.size(); i++) {
-            if (blocks[i] != nullptr) free(blocks[i]);
+            if (blocks[i] != nullptr) {
+#if defined(WITH_LFORTRAN_ASSERT)
+                // The used part is poisoned, so that a use after free (e.g.
+                // of a string of the AST that the ASR still points to) shows
+                // up in debug builds. The rest was never touched and is not
+                // committed by the OS, it is left alone.
+                std::memset(blocks[i], 0xCD, blocks[i] == start
+                    ? size_current() : block_used[i]);
+#endif
+                free(blocks[i]);
+            }
         }
     }
 
@@ -63,16 +100,70 @@ public:
         }
     }
 
+    // Extends the allocation `p` of `old_size` bytes to `new_size` bytes in
+    // place. This is only possible for the last allocation, if the chunk is
+    // large enough, otherwise false is returned.
+    bool extend(void *p, size_t old_size, size_t new_size) {
+        if ((size_t)p + align(old_size) != current_pos) return false;
+        if ((size_t)p + align(new_size) - (size_t)start > size) return false;
+        current_pos = (size_t)p + align(new_size);
+        return true;
+    }
+
+    // Frees the block `p` of `s` bytes if it is the last allocation,
+    // otherwise does nothing and returns false
+    bool release_last(void *p, size_t s) {
+        if ((size_t)p + align(s) != current_pos) return false;
+        current_pos = (size_t)p;
+        return true;
+    }
+
+    // Gives back the block `p` of `s` bytes, which must not be used anymore.
+    // The last allocation is freed, other blocks are kept for alloc_reuse().
+    void release(void *p, size_t s) {
+        if (release_last(p, s)) return;
+        if (s < sizeof(FreeBlock)) return;
+        size_t c = size_class(s);
+        FreeBlock *b = (FreeBlock*)p;
+        b->next = free_blocks[c];
+        b->size = s;
+        free_blocks[c] = b;
+        released += s;
+    }
+
+    // Like alloc(), but reuses a released block of at least `s` bytes if
+    // there is one
+    void *alloc_reuse(size_t s) {
+        if (s >= sizeof(FreeBlock)) {
+            // The blocks one class up are certainly large enough
+            size_t c = size_class(s - 1) + 1;
+            if (c < n_size_classes && free_blocks[c]) {
+                FreeBlock *b = free_blocks[c];
+                free_blocks[c] = b->next;
+                released -= b->size;
+                return b;
+            }
+        }
+        return alloc(s);
+    }
+
     void *new_chunk(size_t s) {
         size_t snew = std::max(s+ALIGNMENT, 2*size);
+        // alloc() has already reserved `s` bytes in the previous chunk
+        allocated_before += size_current() - align(s);
+        block_used[current_block] = size_current() - align(s);
         start = malloc(snew);
         blocks.push_back(start);
+        block_sizes.push_back(snew);
+        block_used.push_back(0);
+        current_block = blocks.size() - 1;
         if (start == nullptr) {
             throw std::runtime_error("malloc failed.");
         }
         current_pos = (size_t)start;
         current_pos = align(current_pos);
         size = snew;
+        reserved += snew;
 
         size_t addr = current_pos;
         current_pos += align(s);
@@ -102,6 +193,40 @@ public:
         //return new T(std::forward<Args>(args)...);
     }
 
+    // Takes over all chunks of `other`, so that the memory allocated from
+    // `other` lives as long as this allocator. Nothing can be allocated from
+    // `other` afterwards.
+    void absorb(Allocator &other) {
+        if (other.start) {
+            other.block_used[other.current_block] = other.size_current();
+        }
+        blocks.insert(blocks.end(), other.blocks.begin(), other.blocks.end());
+        block_sizes.insert(block_sizes.end(), other.block_sizes.begin(),
+            other.block_sizes.end());
+        block_used.insert(block_used.end(), other.block_used.begin(),
+            other.block_used.end());
+        reserved += other.reserved;
+        allocated_before += other.size_allocated();
+        other.blocks.clear();
+        other.block_sizes.clear();
+        other.block_used.clear();
+        for (size_t c = 0; c < n_size_classes; c++) {
+            if (!other.free_blocks[c]) continue;
+            FreeBlock *last = other.free_blocks[c];
+            while (last->next) last = last->next;
+            last->next = free_blocks[c];
+            free_blocks[c] = other.free_blocks[c];
+            other.free_blocks[c] = nullptr;
+        }
+        released += other.released;
+        other.allocated_before = 0;
+        other.released = 0;
+        other.start = nullptr;
+        other.current_pos = 0;
+        other.size = 0;
+        other.reserved = 0;
+    }
+
     size_t size_current() {
         return current_pos - (size_t)start;
     }
@@ -110,9 +235,42 @@ public:
         return size;
     }
 
+    // The total size of all chunks, i.e. the memory held by the allocator
+    size_t size_reserved() {
+        return reserved;
+    }
+
     size_t num_chunks() {
         return blocks.size();
     }
+
+    // Returns true if `p` points into one of the chunks of this allocator
+    bool owns(const void *p) {
+        // Most often the current chunk, checked first
+        if (start && (size_t)p >= (size_t)start
+                && (size_t)p < (size_t)start + size) {
+            return true;
+        }
+        for (size_t i = 0; i < blocks.size(); i++) {
+            if ((size_t)p >= (size_t)blocks[i]
+                    && (size_t)p < (size_t)blocks[i] + block_sizes[i]) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // The bytes allocated so far from all chunks, the rest of
+    // size_reserved() is the unused space at the end of the chunks
+    size_t size_allocated() {
+        return allocated_before + (start ? size_current() : 0);
+    }
+
+    // The size of the released blocks that have not been reused yet, i.e.
+    // the memory wasted by the regrowth of `Vec`
+    size_t size_released() {
+        return released;
+    }
 };
 
 #endif
@@ -0,0 +1,728 @@
+#include <cmath>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <libasr/asr.h>
+#include <libasr/asr_utils.h>
+#include <libasr/asr_eval.h>
+#include <libasr/string_utils.h>
+
+namespace LFortran {
+
+namespace {
+
+// Thrown when a call cannot be evaluated at compile time
+class NotConstant
+{
+};
+
+// The maximum depth of (recursive) calls of a single evaluation
+const size_t max_depth = 256;
+// The maximum number of statements and calls executed by a single
+// evaluation and by all evaluations of a translation unit
+const size_t max_steps = 1000000;
+const size_t max_total_steps = 10000000;
+
+struct Value {
+    enum class Kind { Integer, Real, Logical, Character };
+    Kind kind = Kind::Integer;
+    int kind_bytes = 4; // The ASR kind of an integer or a real
+    int64_t i = 0; // Integer or logical
+    double r = 0;
+    std::string s;
+
+    // Appends a unique encoding of the value, used as a memoization key
+    void encode(std::string &key) const {
+        key += (char)kind;
+        key += (char)kind_bytes;
+        switch (kind) {
+            case Kind::Integer:
+            case Kind::Logical: {
+                key.append((const char*)&i, sizeof(i));
+                break;
+            }
+            case Kind::Real: {
+                key.append((const char*)&r, sizeof(r));
+                break;
+            }
+            case Kind::Character: {
+                size_t n = s.size();
+                key.append((const char*)&n, sizeof(n));
+                key += s;
+                break;
+            }
+        }
+    }
+};
+
+// Wraps `v` to the width of an integer of ASR kind `kind`
+int64_t wrap_integer(uint64_t v, int kind) {
+    switch (kind) {
+        case 1: return (int8_t)v;
+        case 2: return (int16_t)v;
+        case 4: return (int32_t)v;
+        default: return (int64_t)v;
+    }
+}
+
+double round_real(double r, int kind) {
+    return kind == 4 ? (double)(float)r : r;
+}
+
+Value make_integer(uint64_t v, int kind) {
+    Value x;
+    x.kind = Value::Kind::Integer;
+    x.kind_bytes = kind;
+    x.i = wrap_integer(v, kind);
+    return x;
+}
+
+Value make_real(double r, int kind) {
+    Value x;
+    x.kind = Value::Kind::Real;
+    x.kind_bytes = kind;
+    x.r = round_real(r, kind);
+    return x;
+}
+
+Value make_logical(bool l) {
+    Value x;
+    x.kind = Value::Kind::Logical;
+    x.i = l;
+    return x;
+}
+
+Value make_character(const std::string &s) {
+    Value x;
+    x.kind = Value::Kind::Character;
+    x.kind_bytes = 1;
+    x.s = s;
+    return x;
+}
+
+// Returns the kind of a scalar value of type `t`, throws NotConstant for
+// the other types
+Value::Kind value_kind(const ASR::ttype_t *t) {
+    switch (t->type) {
+        case ASR::ttypeType::Integer: {
+            if (ASR::down_cast<ASR::Integer_t>(t)->n_dims == 0) {
+                return Value::Kind::Integer;
+            }
+            break;
+        }
+        case ASR::ttypeType::Real: {
+            if (ASR::down_cast<ASR::Real_t>(t)->n_dims == 0) {
+                return Value::Kind::Real;
+            }
+            break;
+        }
+        case ASR::ttypeType::Logical: {
+            if (ASR::down_cast<ASR::Logical_t>(t)->n_dims == 0) {
+                return Value::Kind::Logical;
+            }
+            break;
+        }
+        case ASR::ttypeType::Character: {
+            if (ASR::down_cast<ASR::Character_t>(t)->n_dims == 0) {
+                return Value::Kind::Character;
+            }
+            break;
+        }
+        default: break;
+    }
+    throw NotConstant();
+}
+
+// Converts `v` to the type `t` of the variable it is assigned to
+Value convert(const Value &v, const ASR::ttype_t *t) {
+    Value::Kind kind = value_kind(t);
+    if (kind != v.kind) throw NotConstant();
+    int k = ASRUtils::extract_kind_from_ttype_t(t);
+    switch (kind) {
+        case Value::Kind::Integer: return make_integer(v.i, k);
+        case Value::Kind::Real: return make_real(v.r, k);
+        default: return v;
+    }
+}
+
+// Returns the value of a constant expression, throws NotConstant if it is
+// not one
+Value constant_value(ASR::expr_t *e) {
+    switch (e->type) {
+        case ASR::exprType::IntegerConstant: {
+            ASR::IntegerConstant_t *c = ASR::down_cast<ASR::IntegerConstant_t>(e);
+            value_kind(c->m_type);
+            return make_integer(c->m_n,
+                ASRUtils::extract_kind_from_ttype_t(c->m_type));
+        }
+        case ASR::exprType::RealConstant: {
+            ASR::RealConstant_t *c = ASR::down_cast<ASR::RealConstant_t>(e);
+            value_kind(c->m_type);
+            return make_real(c->m_r,
+                ASRUtils::extract_kind_from_ttype_t(c->m_type));
+        }
+        case ASR::exprType::LogicalConstant: {
+            return make_logical(
+                ASR::down_cast<ASR::LogicalConstant_t>(e)->m_value);
+        }
+        case ASR::exprType::StringConstant: {
+            return make_character(
+                ASR::down_cast<ASR::StringConstant_t>(e)->m_s);
+        }
+        default: throw NotConstant();
+    }
+}
+
+// Returns the value of an argument of a call from outside the evaluator, or
+// nullptr if it is not a compile time constant
+ASR::expr_t *argument_value(ASR::expr_t *e) {
+    if (ASR::is_a<ASR::Var_t>(*e)) {
+        // Only a parameter keeps its initial value
+        ASR::symbol_t *s = ASRUtils::symbol_get_past_external(
+            ASR::down_cast<ASR::Var_t>(e)->m_v);
+        if (!ASR::is_a<ASR::Variable_t>(*s)) return nullptr;
+        ASR::Variable_t *v = ASR::down_cast<ASR::Variable_t>(s);
+        if (v->m_storage != ASR::storage_typeType::Parameter) return nullptr;
+        return v->m_value;
+    }
+    return ASRUtils::expr_value(e);
+}
+
+template <typename T>
+bool compare(ASR::cmpopType op, const T &a, const T &b) {
+    switch (op) {
+        case ASR::cmpopType::Eq: return a == b;
+        case ASR::cmpopType::NotEq: return a != b;
+        case ASR::cmpopType::Lt: return a < b;
+        case ASR::cmpopType::LtE: return a <= b;
+        case ASR::cmpopType::Gt: return a > b;
+        case ASR::cmpopType::GtE: return a >= b;
+    }
+    throw NotConstant();
+}
+
+class Evaluator
+{
+public:
+    Allocator &al;
+    size_t total_steps = 0;
+
+    Evaluator(Allocator &al) : al{al} {}
+
+    // Returns the value of the call `x`, or nullptr
+    ASR::expr_t *evaluate(const ASR::FunctionCall_t &x) {
+        std::vector<Value> args;
+        try {
+            for (size_t i=0; i < x.n_args; i++) {
+                if (!x.m_args[i].m_value) return nullptr;
+                ASR::expr_t *v = argument_value(x.m_args[i].m_value);
+                if (!v) return nullptr;
+                args.push_back(constant_value(v));
+            }
+            value_kind(x.m_type);
+        } catch (const NotConstant &) {
+            return nullptr;
+        }
+        if (total_steps >= max_total_steps) return nullptr;
+        steps = 0;
+        depth = 0;
+        limit_exceeded = false;
+        Value r;
+        try {
+            r = call(x.m_name, args);
+        } catch (const NotConstant &) {
+            total_steps += steps;
+            return nullptr;
+        }
+        total_steps += steps;
+        return to_expr(r, x.base.base.loc, x.m_type);
+    }
+
+private:
+    struct Frame {
+        const SymbolTable *symtab; // Of the function
+        std::unordered_map<const ASR::symbol_t*, Value> vars;
+    };
+    enum class Flow { Next, Exit, Cycle, Return };
+
+    std::vector<Frame*> frames;
+    size_t steps = 0;
+    size_t depth = 0;
+    // The results by function and encoded arguments, a failed evaluation is
+    // stored as `false`
+    std::map<const ASR::Function_t*,
+        std::unordered_map<std::string, std::pair<bool, Value>>> memo;
+
+    // Set if the evaluation exceeded a limit, the result then depends on
+    // the caller and is not memoized
+    bool limit_exceeded = false;
+
+    void step() {
+        if (++steps > max_steps) {
+            limit_exceeded = true;
+            throw NotConstant();
+        }
+    }
+
+    ASR::expr_t *to_expr(const Value &v, const Location &loc,
+            ASR::ttype_t *type) {
+        switch (v.kind) {
+            case Value::Kind::Integer: {
+                return ASRUtils::EXPR(ASR::make_IntegerConstant_t(al, loc,
+                    v.i, type));
+            }
+            case Value::Kind::Real: {
+                return ASRUtils::EXPR(ASR::make_RealConstant_t(al, loc,
+                    v.r, type));
+            }
+            case Value::Kind::Logical: {
+                return ASRUtils::EXPR(ASR::make_LogicalConstant_t(al, loc,
+                    v.i, type));
+            }
+            case Value::Kind::Character: {
+                ASR::ttype_t *str_type = ASRUtils::TYPE(
+                    ASR::make_Character_t(al, loc, 1, v.s.size(), nullptr,
+                    nullptr, 0));
+                return ASRUtils::EXPR(ASR::make_StringConstant_t(al, loc,
+                    s2c(al, v.s), str_type));
+            }
+        }
+        return nullptr;
+    }
+
+    Value call(ASR::symbol_t *name, const std::vector<Value> &args) {
+        ASR::symbol_t *s = ASRUtils::symbol_get_past_external(name);
+        if (!ASR::is_a<ASR::Function_t>(*s)) throw NotConstant();
+        ASR::Function_t *f = ASR::down_cast<ASR::Function_t>(s);
+        if (f->m_deftype != ASR::deftypeType::Implementation
+                || f->n_args != args.size()) {
+            throw NotConstant();
+        }
+        if (f->m_abi != ASR::abiType::Source
+                && f->m_abi != ASR::abiType::Intrinsic) {
+            throw NotConstant();
+        }
+        std::string key;
+        for (auto &a : args) a.encode(key);
+        auto &results = memo[f];
+        auto it = results.find(key);
+        if (it != results.end()) {
+            if (!it->second.first) throw NotConstant();
+            return it->second.second;
+        }
+        step();
+        if (depth == max_depth) {
+            limit_exceeded = true;
+            throw NotConstant();
+        }
+        depth++;
+        Frame frame;
+        frame.symtab = f->m_symtab;
+        try {
+            for (size_t i=0; i < f->n_args; i++) {
+                ASR::Variable_t *v = local_variable(f->m_args[i], frame);
+                frame.vars[&v->base] = convert(args[i], v->m_type);
+            }
+            frames.push_back(&frame);
+            execute(f->m_body, f->n_body);
+            frames.pop_back();
+        } catch (const NotConstant &) {
+            if (frames.size() > 0 && frames.back() == &frame) {
+                frames.pop_back();
+            }
+            depth--;
+            if (!limit_exceeded) results[key] = {false, Value()};
+            throw;
+        }
+        depth--;
+        ASR::Variable_t *ret = local_variable(f->m_return_var, frame);
+        auto r = frame.vars.find(&ret->base);
+        if (r == frame.vars.end()) throw NotConstant();
+        results[key] = {true, r->second};
+        return r->second;
+    }
+
+    // Returns the variable of `e`, if it is a Var of a local variable of
+    // the function of `frame`
+    ASR::Variable_t *local_variable(ASR::expr_t *e, const Frame &frame) {
+        if (!ASR::is_a<ASR::Var_t>(*e)) throw NotConstant();
+        ASR::symbol_t *s = ASR::down_cast<ASR::Var_t>(e)->m_v;
+        if (!ASR::is_a<ASR::Variable_t>(*s)) throw NotConstant();
+        ASR::Variable_t *v = ASR::down_cast<ASR::Variable_t>(s);
+        if (v->m_parent_symtab != frame.symtab) throw NotConstant();
+        return v;
+    }
+
+    Flow execute(ASR::stmt_t **body, size_t n_body) {
+        for (size_t i=0; i < n_body; i++) {
+            Flow flow = execute(body[i]);
+            if (flow != Flow::Next) return flow;
+        }
+        return Flow::Next;
+    }
+
+    Flow execute(ASR::stmt_t *x) {
+        step();
+        switch (x->type) {
+            case ASR::stmtType::Assignment: {
+                ASR::Assignment_t *a = ASR::down_cast<ASR::Assignment_t>(x);
+                if (a->m_overloaded) throw NotConstant();
+                ASR::Variable_t *v = local_variable(a->m_target, *frames.back());
+                frames.back()->vars[&v->base] = convert(eval(a->m_value),
+                    v->m_type);
+                return Flow::Next;
+            }
+            case ASR::stmtType::If: {
+                ASR::If_t *s = ASR::down_cast<ASR::If_t>(x);
+                if (eval_logical(s->m_test)) {
+                    return execute(s->m_body, s->n_body);
+                } else {
+                    return execute(s->m_orelse, s->n_orelse);
+                }
+            }
+            case ASR::stmtType::WhileLoop: {
+                ASR::WhileLoop_t *s = ASR::down_cast<ASR::WhileLoop_t>(x);
+                while (eval_logical(s->m_test)) {
+                    Flow flow = execute(s->m_body, s->n_body);
+                    if (flow == Flow::Exit) break;
+                    if (flow == Flow::Return) return flow;
+                    step();
+                }
+                return Flow::Next;
+            }
+            case ASR::stmtType::DoLoop: {
+                ASR::DoLoop_t *s = ASR::down_cast<ASR::DoLoop_t>(x);
+                const ASR::do_loop_head_t &h = s->m_head;
+                if (!h.m_v || !h.m_start || !h.m_end) throw NotConstant();
+                ASR::Variable_t *v = local_variable(h.m_v, *frames.back());
+                Value start = convert(eval(h.m_start), v->m_type);
+                int64_t inc = h.m_increment
+                    ? convert(eval(h.m_increment), v->m_type).i : 1;
+                if (start.kind != Value::Kind::Integer || inc == 0) {
+                    throw NotConstant();
+                }
+                // As in the do_loops pass, the loop variable is stepped
+                // before the body, so that it keeps the last value after the
+                // loop (and `start - inc` if the body never runs), and the
+                // end is evaluated before every iteration
+                Value &i = frames.back()->vars[&v->base];
+                i = make_integer((uint64_t)start.i - (uint64_t)inc,
+                    start.kind_bytes);
+                while (true) {
+                    Value next = make_integer((uint64_t)i.i + (uint64_t)inc,
+                        i.kind_bytes);
+                    Value end = convert(eval(h.m_end), v->m_type);
+                    if (inc > 0 ? next.i > end.i : next.i < end.i) break;
+                    // References to the elements of an unordered_map stay
+                    // valid when it grows
+                    i = next;
+                    Flow flow = execute(s->m_body, s->n_body);
+                    if (flow == Flow::Exit) break;
+                    if (flow == Flow::Return) return flow;
+                    step();
+                }
+                return Flow::Next;
+            }
+            case ASR::stmtType::Exit: return Flow::Exit;
+            case ASR::stmtType::Cycle: return Flow::Cycle;
+            case ASR::stmtType::Return: return Flow::Return;
+            case ASR::stmtType::Assert: {
+                ASR::Assert_t *s = ASR::down_cast<ASR::Assert_t>(x);
+                // A failing assert is reported at run time
+                if (!eval_logical(s->m_test)) throw NotConstant();
+                return Flow::Next;
+            }
+            default: throw NotConstant();
+        }
+    }
+
+    bool eval_logical(ASR::expr_t *e) {
+        Value v = eval(e);
+        if (v.kind != Value::Kind::Logical) throw NotConstant();
+        return v.i;
+    }
+
+    Value eval(ASR::expr_t *e) {
+        switch (e->type) {
+            case ASR::exprType::IntegerConstant:
+            case ASR::exprType::RealConstant:
+            case ASR::exprType::LogicalConstant:
+            case ASR::exprType::StringConstant: {
+                return constant_value(e);
+            }
+            case ASR::exprType::Var: {
+                ASR::symbol_t *s = ASRUtils::symbol_get_past_external(
+                    ASR::down_cast<ASR::Var_t>(e)->m_v);
+                auto it = frames.back()->vars.find(s);
+                if (it != frames.back()->vars.end()) return it->second;
+                if (ASR::is_a<ASR::Variable_t>(*s)) {
+                    ASR::Variable_t *v = ASR::down_cast<ASR::Variable_t>(s);
+                    if (v->m_storage == ASR::storage_typeType::Parameter
+                            && v->m_value) {
+                        return convert(constant_value(v->m_value),
+                            v->m_type);
+                    }
+                }
+                // Uninitialized, or not a local variable
+                throw NotConstant();
+            }
+            case ASR::exprType::FunctionCall: {
+                ASR::FunctionCall_t *x = ASR::down_cast<ASR::FunctionCall_t>(e);
+                if (x->m_value) return constant_value(x->m_value);
+                std::vector<Value> args;
+                for (size_t i=0; i < x->n_args; i++) {
+                    if (!x->m_args[i].m_value) throw NotConstant();
+                    args.push_back(eval(x->m_args[i].m_value));
+                }
+                return convert(call(x->m_name, args), x->m_type);
+            }
+            case ASR::exprType::IfExp: {
+                ASR::IfExp_t *x = ASR::down_cast<ASR::IfExp_t>(e);
+                return eval_logical(x->m_test) ? eval(x->m_body)
+                    : eval(x->m_orelse);
+            }
+            case ASR::exprType::IntegerUnaryMinus: {
+                ASR::IntegerUnaryMinus_t *x
+                    = ASR::down_cast<ASR::IntegerUnaryMinus_t>(e);
+                Value a = eval(x->m_arg);
+                return make_integer(-(uint64_t)a.i, a.kind_bytes);
+            }
+            case ASR::exprType::IntegerBitNot: {
+                ASR::IntegerBitNot_t *x = ASR::down_cast<ASR::IntegerBitNot_t>(e);
+                Value a = eval(x->m_arg);
+                return make_integer(~(uint64_t)a.i, a.kind_bytes);
+            }
+            case ASR::exprType::IntegerBinOp: {
+                ASR::IntegerBinOp_t *x = ASR::down_cast<ASR::IntegerBinOp_t>(e);
+                return integer_binop(x->m_op, eval(x->m_left),
+                    eval(x->m_right),
+                    ASRUtils::extract_kind_from_ttype_t(x->m_type));
+            }
+            case ASR::exprType::IntegerCompare: {
+                ASR::IntegerCompare_t *x = ASR::down_cast<ASR::IntegerCompare_t>(e);
+                return make_logical(compare(x->m_op, eval(x->m_left).i,
+                    eval(x->m_right).i));
+            }
+            case ASR::exprType::RealUnaryMinus: {
+                ASR::RealUnaryMinus_t *x = ASR::down_cast<ASR::RealUnaryMinus_t>(e);
+                Value a = eval(x->m_arg);
+                return make_real(-a.r, a.kind_bytes);
+            }
+            case ASR::exprType::RealBinOp: {
+                ASR::RealBinOp_t *x = ASR::down_cast<ASR::RealBinOp_t>(e);
+                return real_binop(x->m_op, eval(x->m_left), eval(x->m_right),
+                    ASRUtils::extract_kind_from_ttype_t(x->m_type));
+            }
+            case ASR::exprType::RealCompare: {
+                ASR::RealCompare_t *x = ASR::down_cast<ASR::RealCompare_t>(e);
+                return make_logical(compare(x->m_op, eval(x->m_left).r,
+                    eval(x->m_right).r));
+            }
+            case ASR::exprType::LogicalNot: {
+                ASR::LogicalNot_t *x = ASR::down_cast<ASR::LogicalNot_t>(e);
+                return make_logical(!eval_logical(x->m_arg));
+            }
+            case ASR::exprType::LogicalCompare: {
+                ASR::LogicalCompare_t *x = ASR::down_cast<ASR::LogicalCompare_t>(e);
+                return make_logical(compare(x->m_op, eval(x->m_left).i,
+                    eval(x->m_right).i));
+            }
+            case ASR::exprType::LogicalBinOp: {
+                ASR::LogicalBinOp_t *x = ASR::down_cast<ASR::LogicalBinOp_t>(e);
+                bool a = eval_logical(x->m_left);
+                switch (x->m_op) {
+                    case ASR::logicalbinopType::And: {
+                        return make_logical(a && eval_logical(x->m_right));
+                    }
+                    case ASR::logicalbinopType::Or: {
+                        return make_logical(a || eval_logical(x->m_right));
+                    }
+                    case ASR::logicalbinopType::Xor:
+                    case ASR::logicalbinopType::NEqv: {
+                        return make_logical(a != eval_logical(x->m_right));
+                    }
+                    case ASR::logicalbinopType::Eqv: {
+                        return make_logical(a == eval_logical(x->m_right));
+                    }
+                }
+                throw NotConstant();
+            }
+            case ASR::exprType::StringConcat: {
+                ASR::StringConcat_t *x = ASR::down_cast<ASR::StringConcat_t>(e);
+                Value a = eval(x->m_left), b = eval(x->m_right);
+                if (a.kind != Value::Kind::Character
+                        || b.kind != Value::Kind::Character) {
+                    throw NotConstant();
+                }
+                return make_character(a.s + b.s);
+            }
+            case ASR::exprType::StringRepeat: {
+                ASR::StringRepeat_t *x = ASR::down_cast<ASR::StringRepeat_t>(e);
+                Value a = eval(x->m_left), n = eval(x->m_right);
+                if (a.kind != Value::Kind::Character
+                        || n.kind != Value::Kind::Integer) {
+                    throw NotConstant();
+                }
+                std::string s;
+                for (int64_t i=0; i < n.i; i++) {
+                    step();
+                    s += a.s;
+                }
+                return make_character(s);
+            }
+            case ASR::exprType::StringLen: {
+                ASR::StringLen_t *x = ASR::down_cast<ASR::StringLen_t>(e);
+                Value a = eval(x->m_arg);
+                if (a.kind != Value::Kind::Character) throw NotConstant();
+                return make_integer(a.s.size(),
+                    ASRUtils::extract_kind_from_ttype_t(x->m_type));
+            }
+            case ASR::exprType::StringCompare: {
+                ASR::StringCompare_t *x = ASR::down_cast<ASR::StringCompare_t>(e);
+                return make_logical(compare(x->m_op, eval(x->m_left).s,
+                    eval(x->m_right).s));
+            }
+            case ASR::exprType::Cast: {
+                ASR::Cast_t *x = ASR::down_cast<ASR::Cast_t>(e);
+                return cast(x->m_kind, eval(x->m_arg),
+                    ASRUtils::extract_kind_from_ttype_t(x->m_type));
+            }
+            default: throw NotConstant();
+        }
+    }
+
+    Value integer_binop(ASR::binopType op, const Value &a, const Value &b,
+            int kind) {
+        if (a.kind != Value::Kind::Integer || b.kind != Value::Kind::Integer) {
+            throw NotConstant();
+        }
+        uint64_t x = a.i, y = b.i;
+        switch (op) {
+            case ASR::binopType::Add: return make_integer(x + y, kind);
+            case ASR::binopType::Sub: return make_integer(x - y, kind);
+            case ASR::binopType::Mul: return make_integer(x * y, kind);
+            case ASR::binopType::Div: {
+                // The backends do not agree on negative operands
+                if (a.i < 0 || b.i <= 0) throw NotConstant();
+                return make_integer(a.i / b.i, kind);
+            }
+            case ASR::binopType::Pow: {
+                // Computed in floating point at run time, only the results
+                // that it represents exactly are folded
+                int64_t exact = kind == 8 ? (int64_t)1 << 53 : 1 << 24;
+                if (b.i < 0) throw NotConstant();
+                if (b.i == 0) return make_integer(1, kind);
+                if (a.i == 0 || a.i == 1) return make_integer(a.i, kind);
+                if (a.i == -1) return make_integer(b.i % 2 ? -1 : 1, kind);
+                int64_t r = 1;
+                for (int64_t n=0; n < b.i; n++) {
+                    // Checked before multiplying, so that it cannot overflow
+                    if (a.i > exact || a.i < -exact || (a.i != 0
+                            && std::abs(r) > exact / std::abs(a.i))) {
+                        throw NotConstant();
+                    }
+                    r *= a.i;
+                }
+                return make_integer(r, kind);
+            }
+            case ASR::binopType::BitAnd: return make_integer(x & y, kind);
+            case ASR::binopType::BitOr: return make_integer(x | y, kind);
+            case ASR::binopType::BitXor: return make_integer(x ^ y, kind);
+            case ASR::binopType::BitLShift: {
+                if (b.i < 0 || b.i >= 8*kind) throw NotConstant();
+                return make_integer(x << y, kind);
+            }
+            case ASR::binopType::BitRShift: {
+                if (b.i < 0 || b.i >= 8*kind) throw NotConstant();
+                return make_integer(a.i >> b.i, kind);
+            }
+        }
+        throw NotConstant();
+    }
+
+    Value real_binop(ASR::binopType op, const Value &a, const Value &b,
+            int kind) {
+        if (a.kind != Value::Kind::Real || b.kind != Value::Kind::Real) {
+            throw NotConstant();
+        }
+        switch (op) {
+            case ASR::binopType::Add: return make_real(a.r + b.r, kind);
+            case ASR::binopType::Sub: return make_real(a.r - b.r, kind);
+            case ASR::binopType::Mul: return make_real(a.r * b.r, kind);
+            case ASR::binopType::Div: {
+                if (b.r == 0) throw NotConstant();
+                return make_real(a.r / b.r, kind);
+            }
+            case ASR::binopType::Pow: {
+                if (kind == 4) {
+                    return make_real(std::pow((float)a.r, (float)b.r), kind);
+                }
+                return make_real(std::pow(a.r, b.r), kind);
+            }
+            default: throw NotConstant();
+        }
+    }
+
+    Value cast(ASR::cast_kindType kind, const Value &a, int k) {
+        switch (kind) {
+            case ASR::cast_kindType::IntegerToInteger: {
+                return make_integer(a.i, k);
+            }
+            case ASR::cast_kindType::IntegerToReal: {
+                return make_real(a.i, k);
+            }
+            case ASR::cast_kindType::RealToInteger: {
+                if (!(std::fabs(a.r) < 9.2e18)) throw NotConstant();
+                return make_integer((int64_t)a.r, k);
+            }
+            case ASR::cast_kindType::RealToReal: {
+                return make_real(a.r, k);
+            }
+            case ASR::cast_kindType::LogicalToInteger: {
+                return make_integer(a.i, k);
+            }
+            case ASR::cast_kindType::LogicalToReal: {
+                return make_real(a.i, k);
+            }
+            case ASR::cast_kindType::IntegerToLogical: {
+                return make_logical(a.i != 0);
+            }
+            case ASR::cast_kindType::RealToLogical: {
+                return make_logical(a.r != 0);
+            }
+            case ASR::cast_kindType::CharacterToLogical: {
+                return make_logical(!a.s.empty());
+            }
+            default: throw NotConstant();
+        }
+    }
+};
+
+class EvalPureFunctionCallsVisitor
+    : public ASR::BaseWalkVisitor<EvalPureFunctionCallsVisitor>
+{
+public:
+    Evaluator e;
+
+    EvalPureFunctionCallsVisitor(Allocator &al) : e{al} {}
+
+    void visit_FunctionCall(const ASR::FunctionCall_t &x) {
+        // The arguments first, their values are used
+        BaseWalkVisitor::visit_FunctionCall(x);
+        if (x.m_value) return;
+        ASR::FunctionCall_t &xx = const_cast<ASR::FunctionCall_t&>(x);
+        xx.m_value = e.evaluate(x);
+    }
+};
+
+} // namespace
+
+void eval_pure_function_calls(Allocator &al, ASR::TranslationUnit_t &unit) {
+    EvalPureFunctionCallsVisitor v(al);
+    v.visit_TranslationUnit(unit);
+}
+
+} // namespace LFortran
@@ -0,0 +1,23 @@
+#ifndef LFORTRAN_ASR_EVAL_H
+#define LFORTRAN_ASR_EVAL_H
+
+#include <libasr/asr.h>
+
+namespace LFortran {
+
+    // Evaluates the calls of pure functions with constant arguments at
+    // compile time, by interpreting the ASR of the called functions, and
+    // stores the result in the `value` of the FunctionCall.
+    //
+    // The interpreter supports scalar integer, real, logical and character
+    // values, assignments to local variables, `if`, `do` and `while` loops
+    // and (recursive) calls of other functions. A call is evaluated if it
+    // only executes such code: anything else (printing, a subroutine call, a
+    // global variable, an array, a failing assert, ...) leaves the call to
+    // run time, as does exceeding the recursion depth or the number of steps.
+    // The results are memoized per function and arguments.
+    void eval_pure_function_calls(Allocator &al, ASR::TranslationUnit_t &unit);
+
+} // namespace LFortran
+
+#endif // LFORTRAN_ASR_EVAL_H
@@ -1,60 +1,16 @@
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <iomanip>
 #include <sstream>
+#include <unordered_map>
 
 #include <libasr/asr_scopes.h>
 #include <libasr/asr_utils.h>
+#include <libasr/string_utils.h>
 
 namespace LFortran  {
 
-// This function is taken from:
-// https://github.com/aappleby/smhasher/blob/61a0530f28277f2e850bfc39600ce61d02b518de/src/MurmurHash2.cpp#L37
-uint32_t murmur_hash(const void * key, int len, uint32_t seed)
-{
-    // 'm' and 'r' are mixing constants generated offline.
-    // They're not really 'magic', they just happen to work well.
-    const uint32_t m = 0x5bd1e995;
-    const int r = 24;
-    // Initialize the hash to a 'random' value
-    uint32_t h = seed ^ len;
-    // Mix 4 bytes at a time into the hash
-    const unsigned char * data = (const unsigned char *)key;
-    while(len >= 4)
-    {
-        uint32_t k = *(uint32_t*)data;
-        k *= m;
-        k ^= k >> r;
-        k *= m;
-        h *= m;
-        h ^= k;
-        data += 4;
-        len -= 4;
-    }
-    // Handle the last few bytes of the input array
-    switch(len)
-    {
-        case 3: h ^= data[2] << 16; // fall through
-        case 2: h ^= data[1] << 8;  // fall through
-        case 1: h ^= data[0];
-            h *= m;
-    };
-    // Do a few final mixes of the hash to ensure the last few
-    // bytes are well-incorporated.
-    h ^= h >> 13;
-    h *= m;
-    h ^= h >> 15;
-    return h;
-}
-
-uint32_t murmur_hash_str(const std::string &s, uint32_t seed)
-{
-    return murmur_hash(&s[0], s.length(), seed);
-}
-
-uint32_t murmur_hash_int(uint64_t i, uint32_t seed)
-{
-    return murmur_hash(&i, 8, seed);
-}
-
 template< typename T >
 std::string hexify(T i)
 {
@@ -64,11 +20,94 @@ std::string hexify(T i)
     return buf.str();
 }
 
-unsigned int symbol_table_counter = 0;
+// Atomic, so that symbol tables can be created from several threads (see
+// `CompilerOptions::jobs`)
+std::atomic<unsigned int> symbol_table_counter{0};
+
+// The temporary IDs of DeferredSymbolTableIds count down from the top of the
+// range, so that they do not use up the final ones
+std::atomic<unsigned int> temporary_symbol_table_counter{0};
+
+// The active DeferredSymbolTableIds of this thread, if any
+thread_local DeferredSymbolTableIds *deferred_symbol_table_ids = nullptr;
 
 SymbolTable::SymbolTable(SymbolTable *parent) : parent{parent} {
-    symbol_table_counter++;
-    counter = symbol_table_counter;
+    if (deferred_symbol_table_ids) {
+        counter = --temporary_symbol_table_counter;
+        deferred_symbol_table_ids->symtabs.push_back(this);
+    } else {
+        counter = ++symbol_table_counter;
+    }
+}
+
+DeferredSymbolTableIds::Scope::Scope(DeferredSymbolTableIds &ids)
+        : previous{deferred_symbol_table_ids} {
+    deferred_symbol_table_ids = &ids;
+}
+
+DeferredSymbolTableIds::Scope::~Scope() {
+    deferred_symbol_table_ids = previous;
+}
+
+void DeferredSymbolTableIds::assign() {
+    if (deferred_symbol_table_ids && deferred_symbol_table_ids != this) {
+        // Nested, e.g. the functions lowered in parallel in a module that is
+        // loaded by preload_modules(): assigned with the enclosing ones
+        std::vector<SymbolTable*> &outer = deferred_symbol_table_ids->symtabs;
+        outer.insert(outer.end(), symtabs.begin(), symtabs.end());
+        symtabs.clear();
+        return;
+    }
+    // A contiguous range, even if several threads assign at the same time
+    unsigned int first = symbol_table_counter.fetch_add(symtabs.size());
+    for (size_t i=0; i < symtabs.size(); i++) {
+        symtabs[i]->counter = first + 1 + i;
+    }
+    symtabs.clear();
+}
+
+uint32_t SymbolTable::find_name_id(std::string_view name) {
+    // The keys are the interned strings, which never move. An ID never
+    // changes once interned, a name that is not interned yet is not cached.
+    thread_local std::unordered_map<std::string_view, uint32_t> ids;
+    auto it = ids.find(name);
+    if (it != ids.end()) return it->second;
+    StringInterner &interner = get_string_interner();
+    uint32_t id = interner.find(name);
+    if (id != StringInterner::not_found) ids.emplace(interner.str(id), id);
+    return id;
+}
+
+std::vector<std::pair<std::string, ASR::symbol_t*>>
+        SymbolTable::get_scope() const {
+    std::vector<std::pair<const char*, ASR::symbol_t*>> symbols;
+    symbols.reserve(ids.size());
+    ids.for_each([&](const char *name, ASR::symbol_t *symbol) {
+        symbols.push_back({name, symbol});
+    });
+    std::sort(symbols.begin(), symbols.end(),
+        [](const std::pair<const char*, ASR::symbol_t*> &a,
+           const std::pair<const char*, ASR::symbol_t*> &b) {
+            return std::strcmp(a.first, b.first) < 0;
+        });
+    std::vector<std::pair<std::string, ASR::symbol_t*>> scope;
+    scope.reserve(symbols.size());
+    for (auto &a : symbols) scope.push_back({a.first, a.second});
+    return scope;
+}
+
+uint32_t SymbolTable::get_hash_uint32() {
+    // The names are visited in order, so the hash is stable
+    uint32_t hash = 0;
+    for (auto &a : get_scope()) {
+        hash = murmur_hash_str(a.first, hash);
+        hash = murmur_hash_int((uint64_t)a.second->type, hash);
+    }
+    return hash;
+}
+
+void SymbolTable::assign_new_counter() {
+    counter = ++symbol_table_counter;
 }
 
 void SymbolTable::reset_global_counter() {
@@ -76,22 +115,22 @@ void SymbolTable::reset_global_counter() {
 }
 
 void SymbolTable::mark_all_variables_external(Allocator &/*al*/) {
-    for (auto &a : scope) {
-        switch (a.second->type) {
+    ids.for_each([](const char */*name*/, ASR::symbol_t *symbol) {
+        switch (symbol->type) {
             case (ASR::symbolType::Variable) : {
-                ASR::Variable_t *v = ASR::down_cast<ASR::Variable_t>(a.second);
+                ASR::Variable_t *v = ASR::down_cast<ASR::Variable_t>(symbol);
                 v->m_abi = ASR::abiType::Interactive;
                 break;
             }
             case (ASR::symbolType::Function) : {
-                ASR::Function_t *v = ASR::down_cast<ASR::Function_t>(a.second);
+                ASR::Function_t *v = ASR::down_cast<ASR::Function_t>(symbol);
                 v->m_abi = ASR::abiType::Interactive;
                 v->m_body = nullptr;
                 v->n_body = 0;
                 break;
             }
             case (ASR::symbolType::Subroutine) : {
-                ASR::Subroutine_t *v = ASR::down_cast<ASR::Subroutine_t>(a.second);
+                ASR::Subroutine_t *v = ASR::down_cast<ASR::Subroutine_t>(symbol);
                 v->m_abi = ASR::abiType::Interactive;
                 v->m_body = nullptr;
                 v->n_body = 0;
@@ -99,16 +138,15 @@ void SymbolTable::mark_all_variables_external(Allocator &/*al*/) {
             }
             default : {};
         }
-    }
+    });
 }
 
 ASR::symbol_t *SymbolTable::find_scoped_symbol(const std::string &name,
         size_t n_scope_names, char **m_scope_names) {
     const SymbolTable *s = this;
     for(size_t i=0; i < n_scope_names; i++) {
-        std::string scope_name = m_scope_names[i];
-        if (s->scope.find(scope_name) != scope.end()) {
-            ASR::symbol_t *sym = s->scope.at(scope_name);
+        ASR::symbol_t *sym = s->get_symbol(m_scope_names[i]);
+        if (sym) {
             s = ASRUtils::symbol_symtab(sym);
             if (s == nullptr) {
                 // The m_scope_names[i] found in the appropriate symbol table,
@@ -121,9 +159,8 @@ ASR::symbol_t *SymbolTable::find_scoped_symbol(const std::string &name,
             return nullptr;
         }
     }
-    if (s->scope.find(name) != scope.end()) {
-        ASR::symbol_t *sym = s->scope.at(name);
-        LFORTRAN_ASSERT(sym)
+    ASR::symbol_t *sym = s->get_symbol(name);
+    if (sym) {
         return sym;
     } else {
         // The `name` not found in the appropriate symbol table
@@ -134,7 +171,7 @@ ASR::symbol_t *SymbolTable::find_scoped_symbol(const std::string &name,
 std::string SymbolTable::get_unique_name(const std::string &name) {
     std::string unique_name = name;
     int counter = 1;
-    while (scope.find(unique_name) != scope.end()) {
+    while (get_symbol(unique_name)) {
         unique_name = name + std::to_string(counter);
         counter++;
     }
@@ -1,9 +1,13 @@
 #ifndef LFORTRAN_SEMANTICS_ASR_SCOPES_H
 #define LFORTRAN_SEMANTICS_ASR_SCOPES_H
 
-#include <map>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include <libasr/alloc.h>
+#include <libasr/assert.h>
+#include <libasr/string_interner.h>
 
 namespace LFortran  {
 
@@ -12,9 +16,107 @@ namespace ASR {
     struct symbol_t;
 }
 
+// An open addressing hash table (with linear probing) from the interned ID of
+// a name (see StringInterner) to a symbol. The hash of each ID is stored in
+// its slot, so that it is computed only once and probing compares integers.
+// The slots are in no particular order.
+class SymbolIndex {
+    struct Slot {
+        uint32_t id;
+        uint32_t hash;
+        const char *name; // The interned name
+        ASR::symbol_t *symbol; // nullptr if the slot is empty
+    };
+    std::vector<Slot> slots; // The size is zero or a power of two
+    size_t n = 0;
+
+    // The finalizer of MurmurHash3, the IDs are mostly small and sequential
+    static uint32_t hash_id(uint32_t id) {
+        id ^= id >> 16;
+        id *= 0x85ebca6b;
+        id ^= id >> 13;
+        id *= 0xc2b2ae35;
+        id ^= id >> 16;
+        return id;
+    }
+
+    void grow() {
+        std::vector<Slot> old(std::max<size_t>(8, 2*slots.size()));
+        old.swap(slots);
+        size_t mask = slots.size() - 1;
+        for (auto &s : old) {
+            if (!s.symbol) continue;
+            size_t i = s.hash & mask;
+            while (slots[i].symbol) i = (i + 1) & mask;
+            slots[i] = s;
+        }
+    }
+
+public:
+    // Returns `nullptr` if `id` is not in the table
+    ASR::symbol_t* find(uint32_t id) const {
+        if (slots.empty()) return nullptr;
+        size_t mask = slots.size() - 1;
+        for (size_t i = hash_id(id) & mask; slots[i].symbol; i = (i + 1) & mask) {
+            if (slots[i].id == id) return slots[i].symbol;
+        }
+        return nullptr;
+    }
+
+    // Inserts or replaces the symbol of `id`, whose interned name is `name`
+    void insert(uint32_t id, const char *name, ASR::symbol_t *symbol) {
+        LFORTRAN_ASSERT(symbol != nullptr);
+        // Keep the load factor at most 1/2
+        if (2*(n + 1) > slots.size()) grow();
+        size_t mask = slots.size() - 1;
+        uint32_t hash = hash_id(id);
+        size_t i = hash & mask;
+        while (slots[i].symbol && slots[i].id != id) i = (i + 1) & mask;
+        if (!slots[i].symbol) n++;
+        slots[i] = {id, hash, name, symbol};
+    }
+
+    void erase(uint32_t id) {
+        if (slots.empty()) return;
+        size_t mask = slots.size() - 1;
+        size_t i = hash_id(id) & mask;
+        while (slots[i].symbol && slots[i].id != id) i = (i + 1) & mask;
+        if (!slots[i].symbol) return;
+        // Shift the following slots of the probe sequence back, instead of
+        // leaving a tombstone
+        for (size_t j = (i + 1) & mask; slots[j].symbol; j = (j + 1) & mask) {
+            size_t k = slots[j].hash & mask; // Where the slot `j` belongs
+            bool k_in_i_j = (i <= j) ? (i < k && k <= j) : (i < k || k <= j);
+            if (k_in_i_j) continue;
+            slots[i] = slots[j];
+            i = j;
+        }
+        slots[i].symbol = nullptr;
+        n--;
+    }
+
+    void clear() {
+        slots.clear();
+        n = 0;
+    }
+
+    size_t size() const {
+        return n;
+    }
+
+    // Calls `f(name, symbol)` for each symbol, in no particular order
+    template <typename F>
+    void for_each(F f) const {
+        for (auto &s : slots) {
+            if (s.symbol) f(s.name, s.symbol);
+        }
+    }
+};
+
 struct SymbolTable {
     private:
-    std::map<std::string, ASR::symbol_t*> scope;
+    // The symbols by the interned IDs of their names
+    SymbolIndex ids;
 
     public:
     SymbolTable *parent;
@@ -23,7 +125,7 @@ struct SymbolTable {
     // * symbol_symtab(down_cast<symbol_t>(this->asr_owner)) == this
     // * down_cast2<TranslationUnit_t>(this->asr_owner)->m_global_scope == this
     ASR::asr_t *asr_owner = nullptr;
-    unsigned int counter;
+    unsigned int counter; // A unique ID, see also DeferredSymbolTableIds
 
     SymbolTable(SymbolTable *parent);
 
@@ -33,43 +135,62 @@ struct SymbolTable {
         return std::to_string(counter);
     }
     static void reset_global_counter(); // Resets the internal global counter
+    void assign_new_counter(); // Assigns a new unique ID
+
+    // The interned ID of `name`, or StringInterner::not_found if it was never
+    // interned (then it is not in any symbol table). The IDs found are cached
+    // by each thread, so that a lookup does not lock the StringInterner.
+    static uint32_t find_name_id(std::string_view name);
 
     // Resolves the symbol `name` recursively in current and parent scopes.
     // Returns `nullptr` if symbol not found.
-    ASR::symbol_t* resolve_symbol(const std::string &name) {
-        if (scope.find(name) == scope.end()) {
-            if (parent) {
-                return parent->resolve_symbol(name);
-            } else {
-                return nullptr;
-            }
+    ASR::symbol_t* resolve_symbol(std::string_view name) const {
+        uint32_t id = find_name_id(name);
+        if (id == StringInterner::not_found) return nullptr;
+        return resolve_symbol(id);
+    }
+
+    // Resolves the symbol with the interned name `id`, see above
+    ASR::symbol_t* resolve_symbol(uint32_t id) const {
+        for (const SymbolTable *s = this; s; s = s->parent) {
+            ASR::symbol_t *sym = s->ids.find(id);
+            if (sym) return sym;
         }
-        return scope[name];
+        return nullptr;
     }
 
-    const std::map<std::string, ASR::symbol_t*>& get_scope() const {
-        return scope;
+    // The symbols sorted by name, so that iterating over them is
+    // deterministic. It is a copy, the passes add and erase symbols while
+    // they iterate. Use get_symbol() to look up a name.
+    std::vector<std::pair<std::string, ASR::symbol_t*>> get_scope() const;
+
+    // The number of symbols in the current symbol table
+    size_t n_symbols() const {
+        return ids.size();
     }
 
     // Obtains the symbol `name` from the current symbol table
     // Returns `nullptr` if symbol not found.
-    ASR::symbol_t* get_symbol(const std::string &name) const {
-        //auto it = scope.find(to_lower(name));
-        auto it = scope.find(name);
-        if (it == scope.end()) {
-            return nullptr;
-        } else {
-            return it->second;
-        }
+    ASR::symbol_t* get_symbol(std::string_view name) const {
+        uint32_t id = find_name_id(name);
+        if (id == StringInterner::not_found) return nullptr;
+        return get_symbol(id);
+    }
+
+    // Obtains the symbol with the interned name `id`, see above
+    ASR::symbol_t* get_symbol(uint32_t id) const {
+        return ids.find(id);
     }
 
     void erase_symbol(const std::string &name) {
-        //auto it = scope.find(to_lower(name));
-        scope.erase(name);
+        uint32_t id = find_name_id(name);
+        if (id != StringInterner::not_found) ids.erase(id);
     }
 
     void add_symbol(const std::string &name, ASR::symbol_t* symbol) {
-        scope[name] = symbol;
+        const char *s;
+        uint32_t id = get_string_interner().intern(name, s);
+        ids.insert(id, s, symbol);
     }
 
     // Marks all variables as external
@@ -81,6 +202,32 @@ struct SymbolTable {
     std::string get_unique_name(const std::string &name);
 };
 
+// Makes the IDs (`SymbolTable::counter`) of symbol tables that are created
+// concurrently independent of the scheduling. The symbol tables created by a
+// thread while a DeferredSymbolTableIds is active on it (see Scope) get a
+// temporary unique ID and are recorded, and assign() gives them their final
+// IDs in the order of their creation. The IDs are deterministic if all
+// DeferredSymbolTableIds are assigned in a fixed order, e.g. by one thread
+// after the others are joined.
+class DeferredSymbolTableIds {
+    std::vector<SymbolTable*> symtabs;
+    friend struct SymbolTable;
+public:
+    // Activates `ids` on the calling thread during its lifetime
+    class Scope {
+        DeferredSymbolTableIds *previous;
+    public:
+        Scope(DeferredSymbolTableIds &ids);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+    // Assigns the final IDs to the recorded symbol tables, or hands them on
+    // to the DeferredSymbolTableIds active on the calling thread (if any)
+    void assign();
+};
+
 } // namespace LFortran
 
 #endif // LFORTRAN_SEMANTICS_ASR_SCOPES_H
@@ -65,7 +65,7 @@ std::vector<std::string> determine_module_dependencies(
 }
 
 ASR::Module_t* extract_module(const ASR::TranslationUnit_t &m) {
-    LFORTRAN_ASSERT(m.m_global_scope->get_scope().size()== 1);
+    LFORTRAN_ASSERT(m.m_global_scope->n_symbols()== 1);
     for (auto &a : m.m_global_scope->get_scope()) {
         LFORTRAN_ASSERT(ASR::is_a<ASR::Module_t>(*a.second));
         return ASR::down_cast<ASR::Module_t>(a.second);
@@ -225,9 +225,9 @@ ASR::TranslationUnit_t* find_and_load_module(Allocator &al, const std::string &m
         modfilename = rl_path + "/" + modfilename;
     }
 
-    std::string modfile;
-    if (!read_file(modfilename, modfile)) return nullptr;
-    ASR::TranslationUnit_t *asr = load_modfile(al, modfile, false,
+    MappedFile modfile;
+    if (!modfile.open(modfilename)) return nullptr;
+    ASR::TranslationUnit_t *asr = load_modfile(al, modfile.view(), false,
         symtab);
     if (intrinsic) {
         set_intrinsic(asr);
@@ -773,6 +773,304 @@ int select_generic_procedure(const Vec<ASR::call_arg_t>& args,
     return -1;
 }
 
+GenericProcedureCacheStats generic_procedure_cache_stats;
+
+// Appends everything that types_equal() looks at in `t`
+static void append_type_key(std::string &key, const ASR::ttype_t &t) {
+    int64_t k[2] = {(int64_t)t.type, 0};
+    switch (t.type) {
+        case ASR::ttypeType::Integer:
+        case ASR::ttypeType::Real:
+        case ASR::ttypeType::Complex:
+        case ASR::ttypeType::Logical:
+        case ASR::ttypeType::Character: {
+            k[1] = extract_kind_from_ttype_t(&t);
+            break;
+        }
+        case ASR::ttypeType::Derived: {
+            k[1] = (int64_t)symbol_get_past_external(
+                ASR::down_cast<ASR::Derived_t>(&t)->m_derived_type);
+            break;
+        }
+        case ASR::ttypeType::Class: {
+            k[1] = (int64_t)symbol_get_past_external(
+                ASR::down_cast<ASR::Class_t>(&t)->m_class_type);
+            break;
+        }
+        default: break;
+    }
+    key.append((const char*)k, sizeof(k));
+}
+
+int GenericProcedureCache::select(const Vec<ASR::call_arg_t> &args,
+        const ASR::GenericProcedure_t &p, const Location &loc,
+        const std::function<void (const std::string &, const Location &)> err) {
+    key.clear();
+    const ASR::GenericProcedure_t *pp = &p;
+    key.append((const char*)&pp, sizeof(pp));
+    for (size_t i=0; i < args.size(); i++) {
+        append_type_key(key, *expr_type(args[i].m_value));
+    }
+    auto it = cache.find(key);
+    if (it != cache.end()) {
+        generic_procedure_cache_stats.hits.fetch_add(1,
+            std::memory_order_relaxed);
+        return it->second;
+    }
+    generic_procedure_cache_stats.misses.fetch_add(1,
+        std::memory_order_relaxed);
+    int idx = select_generic_procedure(args, p, loc, err);
+    if (idx >= 0) cache[key] = idx;
+    return idx;
+}
+
+namespace {
+    thread_local TypeInterner *current_type_interner = nullptr;
+}
+
+ASR::ttype_t* intern_type(ASR::ttype_t *t) {
+    if (!current_type_interner) return t;
+    return current_type_interner->intern(t);
+}
+
+TypeInterner::Scope::Scope(TypeInterner *types)
+        : previous{current_type_interner} {
+    current_type_interner = types;
+}
+
+TypeInterner::Scope::~Scope() {
+    current_type_interner = previous;
+}
+
+TypeInterner* TypeInterner::current() {
+    return current_type_interner;
+}
+
+bool TypeInterner::get_key(const ASR::ttype_t &t, uint64_t &key) {
+    int64_t kind, len = 0;
+    switch (t.type) {
+        case ASR::ttypeType::Integer: {
+            const ASR::Integer_t &x = (const ASR::Integer_t&)t;
+            if (x.n_dims > 0) return false;
+            kind = x.m_kind;
+            break;
+        }
+        case ASR::ttypeType::Real: {
+            const ASR::Real_t &x = (const ASR::Real_t&)t;
+            if (x.n_dims > 0) return false;
+            kind = x.m_kind;
+            break;
+        }
+        case ASR::ttypeType::Complex: {
+            const ASR::Complex_t &x = (const ASR::Complex_t&)t;
+            if (x.n_dims > 0) return false;
+            kind = x.m_kind;
+            break;
+        }
+        case ASR::ttypeType::Logical: {
+            const ASR::Logical_t &x = (const ASR::Logical_t&)t;
+            if (x.n_dims > 0) return false;
+            kind = x.m_kind;
+            break;
+        }
+        case ASR::ttypeType::Character: {
+            const ASR::Character_t &x = (const ASR::Character_t&)t;
+            if (x.n_dims > 0 || x.m_len_expr) return false;
+            kind = x.m_kind;
+            len = x.m_len;
+            break;
+        }
+        default: return false;
+    }
+    // 8 bits for the type and the kind, 48 bits for the length
+    if (kind < 0 || kind > 0xFF || len < 0 || len >= ((int64_t)1 << 48)) {
+        return false;
+    }
+    key = ((uint64_t)t.type << 56) | ((uint64_t)kind << 48) | (uint64_t)len;
+    return true;
+}
+
+ASR::ttype_t* TypeInterner::intern(ASR::ttype_t *t) {
+    uint64_t key;
+    if (!get_key(*t, key) || !al.owns(t)) return t;
+    auto r = types.try_emplace(key, t);
+    if (r.second) return t;
+    ASR::ttype_t *interned = r.first->second;
+    if (interned != t) {
+        // A duplicate just constructed by TYPE(ASR::make_..._t(al, ...)) is
+        // the last allocation, which is freed
+        size_t size;
+        switch (t->type) {
+            case ASR::ttypeType::Integer: size = sizeof(ASR::Integer_t); break;
+            case ASR::ttypeType::Real: size = sizeof(ASR::Real_t); break;
+            case ASR::ttypeType::Complex: size = sizeof(ASR::Complex_t); break;
+            case ASR::ttypeType::Logical: size = sizeof(ASR::Logical_t); break;
+            default: size = sizeof(ASR::Character_t); break;
+        }
+        al.release_last(t, size);
+    }
+    return interned;
+}
+
+bool TypeInterner::verify(std::string &error) const {
+    for (auto &a : types) {
+        uint64_t key;
+        if (!get_key(*a.second, key) || key != a.first) {
+            error = "The interned type at "
+                + std::to_string(a.second->base.loc.first)
+                + " was modified in place";
+            return false;
+        }
+    }
+    return true;
+}
+
+class StructuralHashVisitor
+    : public ASR::StructuralHashBaseVisitor<StructuralHashVisitor> {
+    std::unordered_map<const void*, uint64_t> &cache;
+public:
+    StructuralHashVisitor(std::unordered_map<const void*, uint64_t> &cache)
+        : cache{cache} {}
+
+    template <class T>
+    uint64_t hash_of(const T &x) {
+        auto it = cache.find(&x);
+        if (it != cache.end()) return it->second;
+        uint64_t h = hash;
+        hash = 0;
+        visit(x);
+        uint64_t result = hash;
+        hash = h;
+        cache[&x] = result;
+        return result;
+    }
+
+    void visit(const ASR::expr_t &x) {
+        visit_expr(x);
+    }
+
+    void visit(const ASR::stmt_t &x) {
+        visit_stmt(x);
+    }
+
+    void mix_expr(const ASR::expr_t &x) {
+        mix(hash_of(x));
+    }
+
+    void mix_stmt(const ASR::stmt_t &x) {
+        mix(hash_of(x));
+    }
+
+    void mix_symbol_ref(const ASR::symbol_t &x) {
+        mix(x.type);
+        mix_string(symbol_name(&x));
+    }
+};
+
+uint64_t StructuralHasher::hash(const ASR::expr_t &x) {
+    StructuralHashVisitor v(cache);
+    return v.hash_of(x);
+}
+
+uint64_t StructuralHasher::hash(const ASR::stmt_t &x) {
+    StructuralHashVisitor v(cache);
+    return v.hash_of(x);
+}
+
+uint64_t StructuralHasher::hash(ASR::stmt_t **m_body, size_t n_body) {
+    StructuralHashVisitor v(cache);
+    v.mix(n_body);
+    for (size_t i = 0; i < n_body; i++) {
+        v.mix_stmt(*m_body[i]);
+    }
+    return v.hash;
+}
+
+uint64_t StructuralHasher::hash(const ASR::Function_t &x) {
+    StructuralHashVisitor v(cache);
+    ASR::Function_t unnamed = x;
+    unnamed.m_name = nullptr;
+    v.visit_Function(unnamed);
+    return v.hash;
+}
+
+class NodeCounter : public ASR::BaseIterativeWalkVisitor<NodeCounter> {
+public:
+    size_t n = 0;
+
+    void visit_stmt(const ASR::stmt_t &x) {
+        n++;
+        BaseIterativeWalkVisitor::visit_stmt(x);
+    }
+
+    void visit_expr(const ASR::expr_t &x) {
+        n++;
+        BaseIterativeWalkVisitor::visit_expr(x);
+    }
+
+    void visit_ttype(const ASR::ttype_t &x) {
+        n++;
+        BaseIterativeWalkVisitor::visit_ttype(x);
+    }
+};
+
+// The walk visitors do not call visit_symbol() for the symbols in the symbol
+// tables, so these are counted separately
+static size_t count_symbols(const SymbolTable &symtab) {
+    size_t n = symtab.n_symbols();
+    for (auto &a : symtab.get_scope()) {
+        SymbolTable *s = symbol_symtab(a.second);
+        if (s) n += count_symbols(*s);
+    }
+    return n;
+}
+
+size_t count_nodes(const ASR::TranslationUnit_t &unit) {
+    NodeCounter v;
+    v.visit_TranslationUnit(unit);
+    return v.n + count_symbols(*unit.m_global_scope);
+}
+
+class StringCopier : public ASR::BaseStringWalkVisitor<StringCopier> {
+    Allocator &al, &from;
+public:
+    StringCopier(Allocator &al, Allocator &from) : al{al}, from{from} {}
+
+    void visit_string(char *&s) {
+        if (s && from.owns(s)) s = s2c(al, s);
+    }
+
+    void visit_string_array(char **&a, size_t n) {
+        if (a && from.owns(a)) {
+            char **a2 = al.allocate<char*>(n);
+            std::copy(a, a + n, a2);
+            a = a2;
+        }
+    }
+
+    // The nodes themselves are never allocated from `from`
+    void visit_stmt(const ASR::stmt_t &x) {
+        LFORTRAN_ASSERT(!from.owns(&x));
+        BaseStringWalkVisitor::visit_stmt(x);
+    }
+
+    void visit_expr(const ASR::expr_t &x) {
+        LFORTRAN_ASSERT(!from.owns(&x));
+        BaseStringWalkVisitor::visit_expr(x);
+    }
+
+    void visit_ttype(const ASR::ttype_t &x) {
+        LFORTRAN_ASSERT(!from.owns(&x));
+        BaseStringWalkVisitor::visit_ttype(x);
+    }
+};
+
+void copy_strings_from(Allocator &al, ASR::TranslationUnit_t &unit,
+        Allocator &from) {
+    StringCopier v(al, from);
+    v.visit_TranslationUnit(unit);
+}
+
 ASR::asr_t* symbol_resolve_external_generic_procedure_without_eval(
             const Location &loc,
             ASR::symbol_t *v, Vec<ASR::call_arg_t>& args,
@@ -1,10 +1,12 @@
 #ifndef LFORTRAN_ASR_UTILS_H
 #define LFORTRAN_ASR_UTILS_H
 
+#include <atomic>
 #include <functional>
 #include <map>
 #include <set>
 #include <limits>
+#include <unordered_map>
 
 #include <libasr/assert.h>
 #include <libasr/asr.h>
@@ -33,9 +35,14 @@ static inline ASR::case_stmt_t* CASE_STMT(const ASR::asr_t *f)
     return ASR::down_cast<ASR::case_stmt_t>(f);
 }
 
+// Returns the shared node equal to `t` if a TypeInterner is active on this
+// thread, otherwise `t`
+ASR::ttype_t* intern_type(ASR::ttype_t *t);
+
+// Types are constructed as TYPE(ASR::make_..._t(al, ...)), see TypeInterner
 static inline ASR::ttype_t* TYPE(const ASR::asr_t *f)
 {
-    return ASR::down_cast<ASR::ttype_t>(f);
+    return intern_type(ASR::down_cast<ASR::ttype_t>(f));
 }
 
 static inline ASR::symbol_t *symbol_get_past_external(ASR::symbol_t *f)
@@ -296,6 +303,12 @@ static inline SymbolTable *symbol_symtab(const ASR::symbol_t *f)
             return nullptr;
             //throw LFortranException("GenericProcedure does not have a symtab");
         }
+        case ASR::symbolType::CustomOperator: {
+            return nullptr;
+        }
+        case ASR::symbolType::ClassType: {
+            return ASR::down_cast<ASR::ClassType_t>(f)->m_symtab;
+        }
         case ASR::symbolType::DerivedType: {
             return ASR::down_cast<ASR::DerivedType_t>(f)->m_symtab;
         }
@@ -1171,6 +1184,10 @@ inline int extract_len(ASR::expr_t* len_expr, const Location& loc) {
 }
 
 inline bool check_equal_type(ASR::ttype_t* x, ASR::ttype_t* y) {
+    if (x == y) {
+        // Always the case for equal interned types, see TypeInterner
+        return true;
+    }
     if( ASR::is_a<ASR::Pointer_t>(*x) ||
         ASR::is_a<ASR::Pointer_t>(*y) ) {
         x = ASRUtils::type_get_past_pointer(x);
@@ -1223,6 +1240,151 @@ int select_generic_procedure(const Vec<ASR::call_arg_t> &args,
         const std::function<void (const std::string &, const Location &)> err,
         bool raise_error=true);
 
+// The hits and misses of all GenericProcedureCaches, for `--time-report`
+struct GenericProcedureCacheStats {
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+};
+
+extern GenericProcedureCacheStats generic_procedure_cache_stats;
+
+// Caches the procedure that select_generic_procedure() selects by the
+// generic procedure and the types of the arguments, as the same overloads
+// are typically called many times. Not thread safe, each visitor has its
+// own cache.
+class GenericProcedureCache {
+public:
+    int select(const Vec<ASR::call_arg_t> &args,
+        const ASR::GenericProcedure_t &p, const Location &loc,
+        const std::function<void (const std::string &, const Location &)> err);
+
+private:
+    std::unordered_map<std::string, int> cache;
+    std::string key;
+};
+
+// Shares one node between all equal scalar types: Integer, Real, Complex and
+// Logical without dimensions and Character of a constant length without
+// dimensions. The ASR of a module uses a handful of such types thousands of
+// times, interning them saves the memory of the duplicates and makes the
+// comparison of equal types a pointer comparison (see check_equal_type()).
+//
+// While a TypeInterner::Scope is alive, TYPE() interns the types constructed
+// on the same thread:
+//
+//     TypeInterner types(al);
+//     TypeInterner::Scope scope(types);
+//     ASR::ttype_t *a = TYPE(ASR::make_Integer_t(al, loc, 4, nullptr, 0));
+//     ASR::ttype_t *b = TYPE(ASR::make_Integer_t(al, loc, 4, nullptr, 0));
+//     // a == b
+//
+// As interned types are shared, they must never be modified in place; a node
+// that needs different dimensions gets a new type instead. asr_verify()
+// checks that for the TypeInterner active on the calling thread. For the
+// same reason the location of a type is that of its first occurrence, which
+// can be anywhere in the unit: diagnostics use the location of the
+// expression or the statement instead.
+class TypeInterner {
+public:
+    // `al` is the Allocator the types are constructed with, the duplicates
+    // are given back to it
+    TypeInterner(Allocator &al) : al{al} {}
+    TypeInterner(const TypeInterner&) = delete;
+    TypeInterner& operator=(const TypeInterner&) = delete;
+
+    // Makes `types` the TypeInterner of the current thread for its lifetime,
+    // nullptr turns interning off (e.g. on a thread that allocates from an
+    // Allocator of its own)
+    class Scope {
+        TypeInterner *previous;
+    public:
+        Scope(TypeInterner &types) : Scope(&types) {}
+        Scope(TypeInterner *types);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+    // The TypeInterner of the current thread, nullptr if there is none
+    static TypeInterner* current();
+
+    // Returns the interned node equal to `t`, or `t` if it cannot be
+    // interned. Only the nodes allocated from `al` are interned, as the
+    // nodes of another Allocator may not live as long.
+    ASR::ttype_t* intern(ASR::ttype_t *t);
+
+    // Returns false and sets `error` if an interned node was modified
+    bool verify(std::string &error) const;
+
+    // The number of distinct interned types
+    size_t size() const {
+        return types.size();
+    }
+
+private:
+    Allocator &al;
+    std::unordered_map<uint64_t, ASR::ttype_t*> types;
+
+    // Sets `key` for the types that can be interned, returns false otherwise
+    static bool get_key(const ASR::ttype_t &t, uint64_t &key);
+};
+
+// Computes stable, content-based 64-bit hashes of ASR nodes. Equal trees have
+// equal hashes, independent of their locations and of where they are in
+// memory, so the hashes are the same from run to run (as long as ASR.asdl does
+// not change). Symbols that are referenced (e.g. by a Var or a FunctionCall)
+// are hashed by their name, the symbols defined in a symbol table by their
+// contents.
+//
+// The hashes of the expressions and statements are cached when they are first
+// needed, so the nodes must not be modified while a StructuralHasher is in
+// use, unless clear() is called afterwards.
+class StructuralHasher {
+public:
+    StructuralHasher() {}
+    StructuralHasher(const StructuralHasher&) = delete;
+    StructuralHasher& operator=(const StructuralHasher&) = delete;
+
+    uint64_t hash(const ASR::expr_t &x);
+    uint64_t hash(const ASR::stmt_t &x);
+
+    // The hash of the statements of a body
+    uint64_t hash(ASR::stmt_t **m_body, size_t n_body);
+
+    // The hash of a function without its own name, so that functions that
+    // only differ in their names have the same hash
+    uint64_t hash(const ASR::Function_t &x);
+
+    void clear() {
+        cache.clear();
+    }
+
+    // The number of cached hashes
+    size_t size() const {
+        return cache.size();
+    }
+
+private:
+    std::unordered_map<const void*, uint64_t> cache;
+};
+
+// The number of symbols, statements, expressions and types in `unit`. A type
+// used by several nodes is counted for each of them.
+size_t count_nodes(const ASR::TranslationUnit_t &unit);
+
+// Copies the strings of `unit` that were allocated from `from` to `al`, so
+// that `from` can be freed. The ASR shares the names and string constants
+// with the AST it was created from, which lives in its own Allocator.
+//
+// Only the strings (the `char*` fields and the arrays of them, such as the
+// dependencies) are copied. Everything else the ASR points to (the nodes,
+// the arrays of nodes and of call arguments, the symbol tables) must be
+// allocated from `al` already, which is checked for the nodes in debug
+// builds. In particular, a Vec of the ASR must not wrap an array of the AST
+// with Vec::from_pointer_n().
+void copy_strings_from(Allocator &al, ASR::TranslationUnit_t &unit,
+        Allocator &from);
+
 ASR::asr_t* symbol_resolve_external_generic_procedure_without_eval(
             const Location &loc,
             ASR::symbol_t *v, Vec<ASR::call_arg_t>& args,
@@ -539,6 +539,11 @@ public:
 bool asr_verify(const ASR::TranslationUnit_t &unit, bool check_external) {
     ASR::VerifyVisitor v(check_external);
     v.visit_TranslationUnit(unit);
+    // The interned types are shared by the whole ASR
+    if (ASRUtils::TypeInterner *types = ASRUtils::TypeInterner::current()) {
+        std::string error;
+        v.require(types->verify(error), error);
+    }
     return true;
 }
 
@@ -13,6 +13,8 @@ namespace LFortran {
     //   * Types match for function / subroutine calls
     //   * All symbols in the Symbol Table correctly link back to it or the
     //     parent table.
+    //   * The types interned by the TypeInterner of the calling thread were
+    //     not modified.
     //   * All Fortran rules will be checked eventually, such as:
     //     * Initializer expression only uses intrinsic functions
     //     * Any function used in array dimension declaration is pure
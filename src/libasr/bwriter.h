@@ -1,8 +1,12 @@
 #ifndef LFORTRAN_BWRITER_H
 #define LFORTRAN_BWRITER_H
 
+#include <cstring>
 #include <sstream>
 #include <iomanip>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 
 #include <libasr/exception.h>
 
@@ -74,16 +78,19 @@ public:
     }
 
     void write_int8(uint8_t i) {
-        char c=i;
-        s.append(std::string(&c, 1));
+        s += (char)i;
     }
 
     void write_int32(uint32_t i) {
-        s.append(uint32_to_string(i));
+        for (int shift=24; shift >= 0; shift -= 8) {
+            s += (char)((i >> shift) & 0xFF);
+        }
     }
 
     void write_int64(uint64_t i) {
-        s.append(uint64_to_string(i));
+        for (int shift=56; shift >= 0; shift -= 8) {
+            s += (char)((i >> shift) & 0xFF);
+        }
     }
 
     void write_string(const std::string &t) {
@@ -99,13 +106,14 @@ public:
 
 };
 
+// The input is not copied, it must outlive the reader.
 class BinaryReader
 {
 private:
-    std::string s;
+    std::string_view s;
     size_t pos;
 public:
-    BinaryReader(const std::string &s) : s{s}, pos{0} {}
+    BinaryReader(std::string_view s) : s{s}, pos{0} {}
 
     uint8_t read_int8() {
         if (pos+1 > s.size()) {
@@ -134,16 +142,21 @@ public:
         return n;
     }
 
-    std::string read_string() {
+    // The returned view points into the input
+    std::string_view read_string_view() {
         size_t n = read_int64();
-        if (pos+n > s.size()) {
+        if (n > s.size() - pos) {
             throw LFortranException("read_string: String is too short for deserialization.");
         }
-        std::string r = std::string(&s[pos], n);
+        std::string_view r = s.substr(pos, n);
         pos += n;
         return r;
     }
 
+    std::string read_string() {
+        return std::string(read_string_view());
+    }
+
     double read_float64() {
         uint64_t x = read_int64();
         uint64_t *ip = &x;
@@ -189,13 +202,14 @@ public:
     }
 };
 
+// The input is not copied, it must outlive the reader.
 class TextReader
 {
 private:
-    std::string s;
+    std::string_view s;
     size_t pos;
 public:
-    TextReader(const std::string &s) : s{s}, pos{0} {}
+    TextReader(std::string_view s) : s{s}, pos{0} {}
 
     uint8_t read_int8() {
         uint64_t n = read_int64();
@@ -208,6 +222,9 @@ public:
 
     uint64_t read_int64() {
         std::string tmp;
+        if (pos >= s.size()) {
+            throw LFortranException("read_int64: String is too short for deserialization.");
+        }
         while (s[pos] != ' ') {
             tmp += s[pos];
             if (! (s[pos] >= '0' && s[pos] <= '9')) {
@@ -225,6 +242,9 @@ public:
 
     double read_float64() {
         std::string tmp;
+        if (pos >= s.size()) {
+            throw LFortranException("read_float64: String is too short for deserialization.");
+        }
         while (s[pos] != ' ') {
             tmp += s[pos];
             pos++;
@@ -237,12 +257,13 @@ public:
         return n;
     }
 
-    std::string read_string() {
+    // The returned view points into the input
+    std::string_view read_string_view() {
         size_t n = read_int64();
-        if (pos+n > s.size()) {
+        if (n >= s.size() - pos) {
             throw LFortranException("read_string: String is too short for deserialization.");
         }
-        std::string r = std::string(&s[pos], n);
+        std::string_view r = s.substr(pos, n);
         pos += n;
         if (s[pos] != ' ') {
             throw LFortranException("read_string: Space expected.");
@@ -250,6 +271,149 @@ public:
         pos ++;
         return r;
     }
+
+    std::string read_string() {
+        return std::string(read_string_view());
+    }
+};
+
+// Appends `i` to `s` as an unsigned LEB128 integer: 7 bits per byte, least
+// significant first, the high bit set on all bytes but the last
+void static inline append_leb128(std::string &s, uint64_t i) {
+    while (i >= 0x80) {
+        s += (char)((i & 0x7F) | 0x80);
+        i >>= 7;
+    }
+    s += (char)i;
+}
+
+// CompactBinaryWriter / CompactBinaryReader implement a compact binary format.
+// Integers are LEB128 encoded, floats are stored as 8 little endian bytes and
+// each distinct string is stored only once, in a string table in front of the
+// data, and referenced by its index:
+//
+//     n_strings, n_strings x (length, bytes), data
+//
+class CompactBinaryWriter
+{
+private:
+    std::string s;
+    std::unordered_map<std::string, uint64_t> string_ids;
+    std::vector<const std::string*> strings; // Keys of `string_ids` by index
+public:
+    std::string get_str() {
+        std::string r;
+        append_leb128(r, strings.size());
+        for (auto &t : strings) {
+            append_leb128(r, t->size());
+            r.append(*t);
+        }
+        r.append(s);
+        return r;
+    }
+
+    void write_int8(uint8_t i) {
+        s += (char)i;
+    }
+
+    void write_int64(uint64_t i) {
+        append_leb128(s, i);
+    }
+
+    void write_string(const std::string &t) {
+        auto r = string_ids.try_emplace(t, strings.size());
+        if (r.second) strings.push_back(&r.first->first);
+        write_int64(r.first->second);
+    }
+
+    void write_float64(double d) {
+        uint64_t i;
+        std::memcpy(&i, &d, sizeof(i));
+        for (size_t n=0; n < 8; n++) {
+            s += (char)((i >> 8*n) & 0xFF);
+        }
+    }
+};
+
+// Reads the format written by CompactBinaryWriter. The input is not copied,
+// it must outlive the reader.
+class CompactBinaryReader
+{
+private:
+    std::string_view s;
+    size_t pos;
+    std::vector<std::string_view> strings;
+public:
+    CompactBinaryReader(std::string_view s) : s{s}, pos{0} {
+        size_t n = read_int64();
+        if (n > s.size()) {
+            throw LFortranException("CompactBinaryReader: Invalid string table size.");
+        }
+        strings.reserve(n);
+        for (size_t i=0; i < n; i++) {
+            size_t len = read_int64();
+            if (len > s.size() - pos) {
+                throw LFortranException("CompactBinaryReader: String is too short for deserialization.");
+            }
+            strings.push_back(s.substr(pos, len));
+            pos += len;
+        }
+    }
+
+    uint8_t read_int8() {
+        if (pos+1 > s.size()) {
+            throw LFortranException("read_int8: String is too short for deserialization.");
+        }
+        return s[pos++];
+    }
+
+    uint64_t read_int64() {
+        uint64_t n = 0;
+        for (size_t shift=0; shift < 64; shift += 7) {
+            if (pos >= s.size()) {
+                throw LFortranException("read_int64: String is too short for deserialization.");
+            }
+            uint8_t b = s[pos++];
+            n |= (uint64_t)(b & 0x7F) << shift;
+            if (!(b & 0x80)) return n;
+        }
+        throw LFortranException("read_int64: Integer too large to fit 64 bits.");
+    }
+
+    double read_float64() {
+        if (pos+8 > s.size()) {
+            throw LFortranException("read_float64: String is too short for deserialization.");
+        }
+        uint64_t i = 0;
+        for (size_t n=0; n < 8; n++) {
+            i |= (uint64_t)(uint8_t)s[pos+n] << 8*n;
+        }
+        pos += 8;
+        double d;
+        std::memcpy(&d, &i, sizeof(d));
+        return d;
+    }
+
+    // Returns the index of the next string in the string table
+    size_t read_string_id() {
+        uint64_t i = read_int64();
+        if (i >= strings.size()) {
+            throw LFortranException("read_string_id: Invalid string index.");
+        }
+        return i;
+    }
+
+    std::string_view get_string(size_t id) const {
+        return strings[id];
+    }
+
+    size_t n_strings() const {
+        return strings.size();
+    }
+
+    std::string read_string() {
+        return std::string(get_string(read_string_id()));
+    }
 };
 
 } // namespace LFortran
@@ -389,8 +389,7 @@ R"(
             std::vector<std::string> build_order
                 = LFortran::ASRUtils::determine_module_dependencies(x);
             for (auto &item : build_order) {
-                LFORTRAN_ASSERT(x.m_global_scope->get_scope().find(item)
-                    != x.m_global_scope->get_scope().end());
+                LFORTRAN_ASSERT(x.m_global_scope->get_symbol(item) != nullptr);
                 if (startswith(item, "lfortran_intrinsic")) {
                     ASR::symbol_t *mod = x.m_global_scope->get_symbol(item);
                     if( ASRUtils::get_body_size(mod) != 0 ) {
@@ -416,8 +415,7 @@ R"(
         std::vector<std::string> build_order
             = LFortran::ASRUtils::determine_module_dependencies(x);
         for (auto &item : build_order) {
-            LFORTRAN_ASSERT(x.m_global_scope->get_scope().find(item)
-                != x.m_global_scope->get_scope().end());
+            LFORTRAN_ASSERT(x.m_global_scope->get_symbol(item) != nullptr);
             if (!startswith(item, "lfortran_intrinsic")) {
                 ASR::symbol_t *mod = x.m_global_scope->get_symbol(item);
                 visit_symbol(*mod);
@@ -125,8 +125,7 @@ R"(#include <stdio.h>
             std::vector<std::string> build_order
                 = LFortran::ASRUtils::determine_module_dependencies(x);
             for (auto &item : build_order) {
-                LFORTRAN_ASSERT(x.m_global_scope->get_scope().find(item)
-                    != x.m_global_scope->get_scope().end());
+                LFORTRAN_ASSERT(x.m_global_scope->get_symbol(item) != nullptr);
                 if (startswith(item, "lfortran_intrinsic")) {
                     ASR::symbol_t *mod = x.m_global_scope->get_symbol(item);
                     self().visit_symbol(*mod);
@@ -148,8 +147,7 @@ R"(#include <stdio.h>
         std::vector<std::string> build_order
             = LFortran::ASRUtils::determine_module_dependencies(x);
         for (auto &item : build_order) {
-            LFORTRAN_ASSERT(x.m_global_scope->get_scope().find(item)
-                != x.m_global_scope->get_scope().end());
+            LFORTRAN_ASSERT(x.m_global_scope->get_symbol(item) != nullptr);
             if (!startswith(item, "lfortran_intrinsic")) {
                 ASR::symbol_t *mod = x.m_global_scope->get_symbol(item);
                 self().visit_symbol(*mod);
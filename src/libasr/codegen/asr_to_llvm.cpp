@@ -559,7 +559,7 @@ public:
                 dertype2parent[der_type_name] = std::string(par_der_type->m_name);
                 member_idx += 1;
             }
-            const std::map<std::string, ASR::symbol_t*>& scope = der_type->m_symtab->get_scope();
+            auto scope = der_type->m_symtab->get_scope();
             for( auto itr = scope.begin(); itr != scope.end(); itr++ ) {
                 ASR::Variable_t* member = (ASR::Variable_t*)(&(itr->second->base));
                 llvm::Type* llvm_mem_type = getMemberType(member->m_type, member);
@@ -605,7 +605,7 @@ public:
         if( name2dertype.find(der_type_name) != name2dertype.end() ) {
             der_type_llvm = name2dertype[der_type_name];
         } else {
-            const std::map<std::string, ASR::symbol_t*>& scope = der_type->m_symtab->get_scope();
+            auto scope = der_type->m_symtab->get_scope();
             std::vector<llvm::Type*> member_types;
             int member_idx = 0;
             for( auto itr = scope.begin(); itr != scope.end(); itr++ ) {
@@ -44,6 +44,9 @@ template <typename T>
 struct Vec {
     size_t n, max;
     T* p;
+    // False if `p` was not allocated by reserve() or grow(), see
+    // from_pointer_n()
+    bool owned;
 #ifdef WITH_LFORTRAN_ASSERT
     int reserve_called;
 #endif
@@ -55,6 +58,7 @@ struct Vec {
         LFORTRAN_ASSERT(max > 0)
         this->max = max;
         p = al.allocate<T>(max);
+        owned = true;
 #ifdef WITH_LFORTRAN_ASSERT
         reserve_called = vec_called_const;
 #endif
@@ -66,15 +70,40 @@ struct Vec {
         // allocated in memory), but the chance is small. It catches such bugs
         // in practice.
         LFORTRAN_ASSERT(reserve_called == vec_called_const);
-        if (n == max) {
-            size_t max2 = 2*max;
-            T* p2 = al.allocate<T>(max2);
+        if (n == max) grow(al, false);
+        p[n] = x;
+        n++;
+    }
+
+    // Like push_back(), but when the array grows, the old one is released to
+    // `al` for reuse (see Allocator::alloc_reuse()). Only for a Vec that
+    // nothing else points into: no copies of it (Vec is copied by value,
+    // e.g. by the parser) and no nodes built from `p` before it is complete.
+    // An array that `al` did not allocate for this Vec is never released.
+    void push_back_unique(Allocator &al, T x) {
+        LFORTRAN_ASSERT(reserve_called == vec_called_const);
+        if (n == max) grow(al, true);
+        p[n] = x;
+        n++;
+    }
+
+    // Doubles the capacity, in place if possible. Otherwise the elements
+    // are moved to a new array and the old one is left intact (so that a
+    // copy of this Vec still reads the old elements) or, if `release` and
+    // the array is owned by this Vec and `al`, released.
+    void grow(Allocator &al, bool release) {
+        size_t max2 = 2*max;
+        if (!al.extend(p, sizeof(T) * max, sizeof(T) * max2)) {
+            T* p2 = (T*)(release ? al.alloc_reuse(sizeof(T) * max2)
+                : al.alloc(sizeof(T) * max2));
             std::memcpy(p2, p, sizeof(T) * max);
+            if (release && owned && al.owns(p)) {
+                al.release(p, sizeof(T) * max);
+            }
             p = p2;
-            max = max2;
+            owned = true;
         }
-        p[n] = x;
-        n++;
+        max = max2;
     }
 
     size_t size() const {
@@ -104,10 +133,14 @@ struct Vec {
         return std::vector<T>(p, p+n);
     }
 
+    // Uses `p` as the array without copying it. The array is not owned: it
+    // may be a part of another array or come from another Allocator (such
+    // as the AST's), so growing the Vec never releases it.
     void from_pointer_n(T* p, size_t n) {
         this->p = p;
         this->n = n;
         this->max = n;
+        this->owned = false;
 #ifdef WITH_LFORTRAN_ASSERT
         reserve_called = vec_called_const;
 #endif
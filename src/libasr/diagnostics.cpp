@@ -61,7 +61,7 @@ bool Diagnostics::has_error() const {
     return false;
 }
 
-std::string Diagnostics::render(const std::string &input,
+std::string Diagnostics::render(std::string_view input,
         const LocationManager &lm, const CompilerOptions &compiler_options) {
     std::string out;
     for (auto &d : this->diagnostics) {
@@ -90,18 +90,24 @@ std::string Diagnostics::render(const std::string &input,
     return out;
 }
 
-std::string get_line(std::string str, int n)
+// Returns the line `n` (starting from 1) of `str`, without copying `str`. The
+// lines past the end are handled the same way as by `std::getline`.
+std::string get_line(std::string_view str, int n)
 {
-    std::string line;
-    std::stringstream s(str);
+    std::string_view line;
+    size_t start = 0;
     for (int i=0; i < n; i++) {
-        std::getline(s, line);
+        if (start > str.size()) break;
+        size_t end = str.find('\n', start);
+        if (end == std::string_view::npos) end = str.size();
+        line = str.substr(start, end-start);
+        start = end+1;
     }
-    return line;
+    return std::string(line);
 }
 
 void populate_span(diag::Span &s, const LocationManager &lm,
-        const std::string &input) {
+        std::string_view input) {
     lm.pos_to_linecol(lm.output_to_input_pos(s.loc.first, false),
         s.first_line, s.first_column);
     lm.pos_to_linecol(lm.output_to_input_pos(s.loc.last, true),
@@ -115,7 +121,7 @@ void populate_span(diag::Span &s, const LocationManager &lm,
 
 // Loop over all labels and their spans, populate all of them
 void populate_spans(diag::Diagnostic &d, const LocationManager &lm,
-        const std::string &input) {
+        std::string_view input) {
     for (auto &l : d.labels) {
         for (auto &s : l.spans) {
             populate_span(s, lm, input);
@@ -124,7 +130,7 @@ void populate_spans(diag::Diagnostic &d, const LocationManager &lm,
 }
 
 // Fills Diagnostic with span details and renders it
-std::string render_diagnostic(Diagnostic &d, const std::string &input,
+std::string render_diagnostic(Diagnostic &d, std::string_view input,
         const LocationManager &lm, bool use_colors, bool show_stacktrace) {
     std::string out;
     if (show_stacktrace) {
@@ -1,6 +1,8 @@
 #ifndef LFORTRAN_DIAGNOSTICS_H
 #define LFORTRAN_DIAGNOSTICS_H
 
+#include <string_view>
+
 #include <libasr/location.h>
 #include <libasr/stacktrace.h>
 
@@ -113,7 +115,7 @@ struct Diagnostic {
 struct Diagnostics {
     std::vector<Diagnostic> diagnostics;
 
-    std::string render(const std::string &input,
+    std::string render(std::string_view input,
             const LocationManager &lm, const CompilerOptions &compiler_options);
 
     // Returns true iff diagnostics contains at least one error message
@@ -186,7 +188,7 @@ struct Diagnostics {
 std::string render_diagnostic(const Diagnostic &d, bool use_colors);
 
 // Fills Diagnostic with span details and renders it
-std::string render_diagnostic(Diagnostic &d, const std::string &input,
+std::string render_diagnostic(Diagnostic &d, std::string_view input,
         const LocationManager &lm, bool use_colors, bool show_stacktrace); 
 
 } // namespace diag
@@ -0,0 +1,48 @@
+#include <libasr/location.h>
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__SSE2__)
+#  define LFORTRAN_NEWLINES_SIMD
+#  include <immintrin.h>
+#endif
+
+namespace LFortran {
+
+#ifdef LFORTRAN_NEWLINES_SIMD
+// Appends the positions of the set bits of `mask` (one bit per byte starting
+// at `offset`)
+static inline void append_mask(uint32_t mask, uint32_t offset,
+        std::vector<uint32_t> &newlines) {
+    while (mask) {
+        newlines.push_back(offset + __builtin_ctz(mask));
+        mask &= mask - 1;
+    }
+}
+#endif
+
+void LocationManager::get_newlines(std::string_view s,
+        std::vector<uint32_t> &newlines) {
+    const char *p = s.data();
+    uint32_t n = s.size();
+    uint32_t pos = 0;
+#ifdef LFORTRAN_NEWLINES_SIMD
+#  ifdef __AVX2__
+    const __m256i nl32 = _mm256_set1_epi8('\n');
+    for (; pos + 32 <= n; pos += 32) {
+        __m256i c = _mm256_loadu_si256((const __m256i *)(p + pos));
+        append_mask(_mm256_movemask_epi8(_mm256_cmpeq_epi8(c, nl32)), pos,
+            newlines);
+    }
+#  endif
+    const __m128i nl16 = _mm_set1_epi8('\n');
+    for (; pos + 16 <= n; pos += 16) {
+        __m128i c = _mm_loadu_si128((const __m128i *)(p + pos));
+        append_mask(_mm_movemask_epi8(_mm_cmpeq_epi8(c, nl16)), pos,
+            newlines);
+    }
+#endif
+    for (; pos < n; pos++) {
+        if (p[pos] == '\n') newlines.push_back(pos);
+    }
+}
+
+} // namespace LFortran
@@ -2,6 +2,9 @@
 #define LFORTRAN_PARSER_LOCATION_H
 
 #include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
 #include <vector>
 
 namespace LFortran
@@ -96,7 +99,13 @@ struct LocationManager {
     //
     std::vector<uint32_t> out_start; // consecutive intervals in the output code
     std::vector<uint32_t> in_start; // start + size in the original code
-    std::vector<uint32_t> in_newlines; // position of all \n in the original code
+    mutable std::vector<uint32_t> in_newlines; // position of all \n in the original code
+    // The original code whose `in_newlines` were not computed yet, see
+    // init_simple()
+    mutable std::string_view in_pending;
+    // Guards `in_newlines` and `in_pending`: the modules preloaded by `-j`
+    // can render diagnostics from several threads at once
+    mutable std::mutex in_newlines_mutex;
 
     // For preprocessor (if preprocessor==true).
     // TODO: design a common structure, that also works with #include, that
@@ -155,6 +164,11 @@ struct LocationManager {
         if (preprocessor) {
             newlines = &in_newlines0;
         } else {
+            std::lock_guard<std::mutex> lock(in_newlines_mutex);
+            if (in_pending.data()) {
+                get_newlines(in_pending, in_newlines);
+                in_pending = std::string_view();
+            }
             newlines = &in_newlines;
         }
         int32_t interval = bisection(*newlines, position);
@@ -171,17 +185,19 @@ struct LocationManager {
         }
     }
 
-    void get_newlines(const std::string &s, std::vector<uint32_t> &newlines) {
-        for (uint32_t pos=0; pos < s.size(); pos++) {
-            if (s[pos] == '\n') newlines.push_back(pos);
-        }
-    }
+    // Appends the positions of all \n in `s` to `newlines` (vectorized)
+    static void get_newlines(std::string_view s, std::vector<uint32_t> &newlines);
 
-    void init_simple(const std::string &input) {
+    // The `in_newlines` are only computed by the first pos_to_linecol() call,
+    // most compilations never need them. The `input` must stay valid until
+    // then (such as a SourceManager buffer). Not thread safe, unlike
+    // pos_to_linecol().
+    void init_simple(std::string_view input) {
         uint32_t n = input.size();
         out_start = {0, n};
         in_start = {0, n};
-        get_newlines(input, in_newlines);
+        in_newlines.clear();
+        in_pending = input;
     }
 
 };
@@ -10,14 +10,17 @@ namespace LFortran::LPython {
             LFortran::diag::Diagnostics diagnostics;
             LFortran::LocationManager lm;
             lm.in_filename = infile;
-            std::string input = LFortran::read_file(infile);
+            std::string_view input;
+            // The buffers of the previous request are not used anymore
+            LFortran::get_source_manager().release_stale_files();
+            LFortran::get_source_manager().get_file(infile, input);
             lm.init_simple(input);
             LFortran::Result<LFortran::LPython::AST::ast_t*> r1 = LFortran::parse_python_file(
                 al, runtime_library_dir, infile, diagnostics, compiler_options.new_parser);
             if (!r1.ok) return symbol_lists;
             LFortran::LPython::AST::ast_t* ast = r1.result;
-            LFortran::Result<LFortran::ASR::TranslationUnit_t*> x = LFortran::LPython::python_ast_to_asr(al, *ast, diagnostics, true,
-            compiler_options.disable_main, compiler_options.symtab_only, infile);
+            LFortran::Result<LFortran::ASR::TranslationUnit_t*> x = LFortran::LPython::python_ast_to_asr(al, *ast, diagnostics,
+            compiler_options, true, infile);
             if (!x.ok) return symbol_lists;
             lsp_locations loc;
             for (auto &a : x.result->m_global_scope->get_scope()) {
@@ -45,7 +48,10 @@ namespace LFortran::LPython {
             LFortran::diag::Diagnostics diagnostics;
             LFortran::LocationManager lm;
             lm.in_filename = infile;
-            std::string input = LFortran::read_file(infile);
+            std::string_view input;
+            // The buffers of the previous request are not used anymore
+            LFortran::get_source_manager().release_stale_files();
+            LFortran::get_source_manager().get_file(infile, input);
             lm.init_simple(input);
             LFortran::Result<LFortran::LPython::AST::ast_t*>
                 r1 = LFortran::parse_python_file(al, runtime_library_dir, infile, 
@@ -53,8 +59,8 @@ namespace LFortran::LPython {
             if (r1.ok) {
                 LFortran::LPython::AST::ast_t* ast = r1.result;
                 LFortran::Result<LFortran::ASR::TranslationUnit_t*>
-                    r = LFortran::LPython::python_ast_to_asr(al, *ast, diagnostics, true,
-                            compiler_options.disable_main, compiler_options.symtab_only, infile);
+                    r = LFortran::LPython::python_ast_to_asr(al, *ast, diagnostics,
+                            compiler_options, true, infile);
             }
             std::vector<lsp_highlight> diag_lists;
             lsp_highlight h;
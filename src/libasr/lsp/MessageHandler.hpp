@@ -4,6 +4,7 @@
 #include <lpython/utils.h>
 #include <lpython/parser/parser.h>
 #include <libasr/string_utils.h>
+#include <libasr/source_manager.h>
 #include <libasr/diagnostics.h>
 #include <lpython/semantics/python_ast_to_asr.h>
 
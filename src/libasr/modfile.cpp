@@ -6,6 +6,7 @@
 #include <libasr/modfile.h>
 #include <libasr/serialization.h>
 #include <libasr/bwriter.h>
+#include <libasr/string_utils.h>
 
 
 namespace LFortran {
@@ -24,8 +25,10 @@ const std::string lfortran_modfile_type_string = "LFortran Modfile";
 
     Comments below show some possible future improvements to the mod format.
 */
-std::string save_modfile(const ASR::TranslationUnit_t &m) {
-    LFORTRAN_ASSERT(m.m_global_scope->get_scope().size()== 1);
+std::string save_modfile(const ASR::TranslationUnit_t &m,
+        const std::string &source_hash,
+        const std::vector<ModfileDependency> &dependencies) {
+    LFORTRAN_ASSERT(m.m_global_scope->n_symbols()== 1);
     for (auto &a : m.m_global_scope->get_scope()) {
         LFORTRAN_ASSERT(ASR::is_a<ASR::Module_t>(*a.second));
         if ((bool&)a) { } // Suppress unused warning in Release mode
@@ -40,10 +43,17 @@ std::string save_modfile(const ASR::TranslationUnit_t &m) {
     b.write_string(LFORTRAN_VERSION);
 
     // AST section: Original module source code:
-    // Currently empty.
+    // Hash of the orig source code (empty if not known), see source_hash()
+    b.write_string(source_hash);
+    // The module sources it was compiled against and their hashes
+    b.write_int64(dependencies.size());
+    for (auto &dep : dependencies) {
+        b.write_string(dep.module_name);
+        b.write_string(dep.path);
+        b.write_string(dep.source_hash);
+    }
     // Note: in the future we can save here:
     // * A path to the original source code
-    // * Hash of the orig source code
     // * AST binary export of it (this AST only changes if the hash changes)
 
     // ASR section:
@@ -51,32 +61,87 @@ std::string save_modfile(const ASR::TranslationUnit_t &m) {
     // Export ASR:
     // Currently empty.
 
-    // Full ASR:
-    b.write_string(serialize(m));
+    // Full ASR, as an image that is loaded without rebuilding the nodes
+    // (see save_asr_image()):
+    b.write_string(save_asr_image(m));
 
     return b.get_str();
 }
 
-ASR::TranslationUnit_t* load_modfile(Allocator &al, const std::string &s,
-        bool load_symtab_id, SymbolTable &symtab) {
+ASR::TranslationUnit_t* load_modfile(Allocator &al, std::string_view s,
+        bool load_symtab_id, SymbolTable &symtab,
+        std::vector<ASRImageBody> *lazy_bodies) {
 #ifdef WITH_LFORTRAN_BINARY_MODFILES
     BinaryReader b(s);
 #else
     TextReader b(s);
 #endif
-    std::string file_type = b.read_string();
+    std::string_view file_type = b.read_string_view();
     if (file_type != lfortran_modfile_type_string) {
         throw LFortranException("LFortran Modfile format not recognized");
     }
-    std::string version = b.read_string();
+    std::string_view version = b.read_string_view();
     if (version != LFORTRAN_VERSION) {
-        throw LFortranException("Incompatible format: LFortran Modfile was generated using version '" + version + "', but current LFortran version is '" + LFORTRAN_VERSION + "'");
+        throw LFortranException("Incompatible format: LFortran Modfile was generated using version '" + std::string(version) + "', but current LFortran version is '" + LFORTRAN_VERSION + "'");
     }
-    std::string asr_binary = b.read_string();
-    ASR::asr_t *asr = deserialize_asr(al, asr_binary, load_symtab_id, symtab);
+    b.read_string_view(); // source_hash
+    size_t n_dependencies = b.read_int64();
+    for (size_t i=0; i < 3*n_dependencies; i++) {
+        b.read_string_view();
+    }
+    // The image is read in place and only copied once, into `al`
+    std::string_view asr_image = b.read_string_view();
+    ASR::TranslationUnit_t *tu = load_asr_image(al, asr_image,
+        load_symtab_id, lazy_bodies);
+    LFORTRAN_ASSERT(asr_verify(*tu, false));
+
+    // Suppress a warning for now
+    if ((bool&)symtab) {}
 
-    ASR::TranslationUnit_t *tu = ASR::down_cast2<ASR::TranslationUnit_t>(asr);
     return tu;
 }
 
+bool read_modfile_header(std::string_view s, std::string &source_hash,
+        std::vector<ModfileDependency> &dependencies) {
+#ifdef WITH_LFORTRAN_BINARY_MODFILES
+    BinaryReader b(s);
+#else
+    TextReader b(s);
+#endif
+    try {
+        if (b.read_string_view() != lfortran_modfile_type_string) return false;
+        if (b.read_string_view() != LFORTRAN_VERSION) return false;
+        source_hash = b.read_string();
+        size_t n_dependencies = b.read_int64();
+        dependencies.clear();
+        for (size_t i=0; i < n_dependencies; i++) {
+            ModfileDependency dep;
+            dep.module_name = b.read_string();
+            dep.path = b.read_string();
+            dep.source_hash = b.read_string();
+            dependencies.push_back(dep);
+        }
+        return true;
+    } catch (const LFortranException &) {
+        // Truncated or otherwise corrupted modfile
+        return false;
+    }
+}
+
+bool modfile_up_to_date(std::string_view s, const std::string &source_hash) {
+    std::string hash;
+    std::vector<ModfileDependency> dependencies;
+    return read_modfile_header(s, hash, dependencies) && hash == source_hash;
+}
+
+std::string source_hash(std::string_view source) {
+    // Two 32 bit hashes with different seeds make accidental collisions
+    // between two versions of the same module practically impossible
+    uint64_t h = ((uint64_t)murmur_hash(source.data(), source.size(), 0x5a17) << 32)
+        | murmur_hash(source.data(), source.size(), 0x9e37);
+    std::stringstream ss;
+    ss << std::hex << std::setfill('0') << std::setw(16) << h;
+    return ss.str();
+}
+
 } // namespace LFortran
@@ -1,16 +1,47 @@
 #ifndef LFORTRAN_MODFILE_H
 #define LFORTRAN_MODFILE_H
 
+#include <string_view>
+
 #include <libasr/asr.h>
+#include <libasr/serialization.h>
 
 namespace LFortran {
 
-    // Save a module to a modfile
-    std::string save_modfile(const ASR::TranslationUnit_t &m);
+    // A module source that a modfile was compiled against
+    struct ModfileDependency {
+        std::string module_name;
+        std::string path;
+        std::string source_hash;
+    };
+
+    // Save a module to a modfile. The `source_hash` of the module source
+    // code (see source_hash()) is stored so that stale modfiles can be
+    // detected by modfile_up_to_date(). The `dependencies` are stored so that
+    // the caller can also check the sources of the imported modules.
+    std::string save_modfile(const ASR::TranslationUnit_t &m,
+        const std::string &source_hash="",
+        const std::vector<ModfileDependency> &dependencies={});
+
+    // Load a module from a modfile. The modfile `s` is only read, it can be
+    // a MappedFile that is closed afterwards. If `lazy_bodies` is not null,
+    // the function bodies are left to be loaded by load_asr_image_body().
+    ASR::TranslationUnit_t* load_modfile(Allocator &al, std::string_view s,
+        bool load_symtab_id, SymbolTable &symtab,
+        std::vector<ASRImageBody> *lazy_bodies=nullptr);
+
+    // Returns true if the modfile `s` was saved by the current compiler
+    // version from a module source with the hash `source_hash`
+    bool modfile_up_to_date(std::string_view s,
+        const std::string &source_hash);
+
+    // Reads the source hash and the dependencies stored in the modfile `s`.
+    // Returns false if `s` is not a modfile of the current compiler version.
+    bool read_modfile_header(std::string_view s, std::string &source_hash,
+        std::vector<ModfileDependency> &dependencies);
 
-    // Load a module from a modfile
-    ASR::TranslationUnit_t* load_modfile(Allocator &al, const std::string &s,
-        bool load_symtab_id, SymbolTable &symtab);
+    // Stable hash of the module source code
+    std::string source_hash(std::string_view source);
 
 }
 
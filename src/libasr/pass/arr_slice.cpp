@@ -49,6 +49,10 @@ public:
         pass_result.reserve(al, 1);
     }
 
+    ASR::SubtreeKinds relevant_kinds() {
+        return ASR::kinds_of(ASR::exprType::ArraySection);
+    }
+
     ASR::ttype_t* get_array_from_slice(const ASR::ArraySection_t& x, ASR::expr_t* arr_var) {
         Vec<ASR::dimension_t> m_dims;
         m_dims.reserve(al, x.n_args);
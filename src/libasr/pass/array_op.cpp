@@ -227,7 +227,7 @@ public:
         for( auto& item: replace_vec ) {
             current_scope->add_symbol(item.first, item.second);
         }
-        transform_stmts(xx.m_body, xx.n_body);
+        transform_body(&xx.base.base, xx.m_body, xx.n_body);
 
     }
 
@@ -343,7 +343,13 @@ public:
         ASR::dimension_t* m_dims;
         int ndims;
         PassUtils::get_dim_rank(arg_type, m_dims, ndims);
-        PassUtils::set_dim_rank(x_type, m_dims, ndims);
+        // The type can be shared with other nodes (see
+        // ASRUtils::TypeInterner), so it is replaced, not modified
+        ASR::ttype_t* new_type = PassUtils::set_dim_rank(x_type, m_dims,
+            ndims, true, &al);
+        if (new_type) {
+            const_cast<ASR::Cast_t&>(x).m_type = new_type;
+        }
     }
 
     void visit_Cast(const ASR::Cast_t& x) {
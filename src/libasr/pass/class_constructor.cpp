@@ -29,6 +29,10 @@ public:
         pass_result.reserve(al, 0);
     }
 
+    ASR::SubtreeKinds relevant_kinds() {
+        return ASR::kinds_of(ASR::exprType::DerivedTypeConstructor);
+    }
+
     void visit_Subroutine(const ASR::Subroutine_t &x) {
         // FIXME: this is a hack, we need to pass in a non-const `x`,
         // which requires to generate a TransformVisitor.
@@ -48,7 +52,7 @@ public:
                 }
             }
         }
-        transform_stmts(xx.m_body, xx.n_body);
+        transform_body(&xx.base.base, xx.m_body, xx.n_body);
     }
 
     void visit_Assignment(const ASR::Assignment_t& x) {
@@ -41,6 +41,10 @@ public:
 
     }
 
+    ASR::SubtreeKinds relevant_kinds() {
+        return ASR::kinds_of(ASR::stmtType::Assignment);
+    }
+
     void visit_Var(const ASR::Var_t& x) {
         ASR::expr_t* x_expr = (ASR::expr_t*)(&(x.base));
         contains_array = PassUtils::is_array(x_expr);
@@ -4,6 +4,7 @@
 #include <libasr/asr.h>
 #include <libasr/string_utils.h>
 #include <libasr/alloc.h>
+#include <libasr/utils.h>
 
 // TODO: Remove lpython/lfortran includes, make it compiler agnostic
 #if __has_include(<lfortran/utils.h>)
@@ -35,7 +36,9 @@
 #include <libasr/pass/for_all.h>
 #include <libasr/pass/select_case.h>
 #include <libasr/pass/loop_vectorise.h>
+#include <libasr/pass/pass_utils.h>
 
+#include <chrono>
 #include <map>
 #include <vector>
 
@@ -49,6 +52,14 @@ namespace LCompilers {
         forall, select_case, loop_vectorise
     };
 
+    // The state after an ASR pass, see PassManager::pass_reports
+    struct PassReport {
+        std::string name;
+        LFortran::MemoryUsage memory;
+        double time = 0; // Wall time of the pass in ms
+        size_t nodes = 0; // See ASRUtils::count_nodes(), 0 if not counted
+    };
+
     class PassManager {
         private:
 
@@ -79,10 +90,25 @@ namespace LCompilers {
         bool is_fast;
         bool apply_default_passes;
 
+        std::string pass_name(ASRPass pass) {
+            for (auto &it: _passes_db) {
+                if (it.second == pass) return it.first;
+            }
+            return "";
+        }
+
         void _apply_passes(Allocator& al, LFortran::ASR::TranslationUnit_t* asr,
                            std::vector<ASRPass>& passes, std::string& run_fun,
                            bool always_run) {
+            // Lets the passes skip the code that they do not rewrite
+            LFortran::PassUtils::SubtreeKindsCache subtree_kinds;
+            LFortran::PassUtils::SubtreeKindsCache::Scope
+                subtree_kinds_scope(subtree_kinds);
             for (size_t i = 0; i < passes.size(); i++) {
+                if (report_passes && i == 0) {
+                    report_pass(al, asr, "", 0);
+                }
+                auto pass_start = std::chrono::high_resolution_clock::now();
                 switch (passes[i]) {
                     case (ASRPass::do_loops) : {
                         LFortran::pass_replace_do_loops(al, *asr);
@@ -157,11 +183,44 @@ namespace LCompilers {
                         break;
                     }
                 }
+                if (passes[i] == ASRPass::do_loops
+                        || passes[i] == ASRPass::global_stmts
+                        || passes[i] == ASRPass::forall) {
+                    // These change bodies without PassUtils::PassVisitor
+                    subtree_kinds.clear();
+                }
+                if (report_passes) {
+                    auto pass_end = std::chrono::high_resolution_clock::now();
+                    report_pass(al, asr, pass_name(passes[i]),
+                        std::chrono::duration<double, std::milli>(
+                            pass_end - pass_start).count());
+                }
             }
         }
 
+        void report_pass(Allocator &al, LFortran::ASR::TranslationUnit_t* asr,
+                const std::string &name, double time) {
+            auto report_start = std::chrono::high_resolution_clock::now();
+            pass_reports.push_back({name, LFortran::get_memory_usage(al), time,
+                count_pass_nodes ? LFortran::ASRUtils::count_nodes(*asr) : 0});
+            auto report_end = std::chrono::high_resolution_clock::now();
+            report_time += std::chrono::duration<double, std::milli>(
+                report_end - report_start).count();
+        }
+
         public:
 
+        // If true, apply_passes() appends the state before the first pass
+        // (with an empty name) and after each pass to `pass_reports`. Only
+        // if `count_pass_nodes` is also true, the whole ASR is walked to
+        // count its nodes for each report. The time spent on the reports,
+        // which the caller can subtract from its own timings, is added to
+        // `report_time` (in ms).
+        bool report_passes = false;
+        bool count_pass_nodes = false;
+        std::vector<PassReport> pass_reports;
+        double report_time = 0;
+
         PassManager(): is_fast{false}, apply_default_passes{false} {
             _passes = {
                 ASRPass::global_stmts,
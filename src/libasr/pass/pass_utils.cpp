@@ -9,6 +9,41 @@ namespace LFortran {
 
     namespace PassUtils {
 
+        namespace {
+            thread_local SubtreeKindsCache *current_subtree_kinds = nullptr;
+        }
+
+        SubtreeKindsCache::Scope::Scope(SubtreeKindsCache &cache)
+                : previous{current_subtree_kinds} {
+            current_subtree_kinds = &cache;
+        }
+
+        SubtreeKindsCache::Scope::~Scope() {
+            current_subtree_kinds = previous;
+        }
+
+        SubtreeKindsCache* SubtreeKindsCache::current() {
+            return current_subtree_kinds;
+        }
+
+        SubtreeKindsCache::Body& SubtreeKindsCache::get(const ASR::asr_t *owner,
+                ASR::stmt_t **m_body, size_t n_body) {
+            Body &b = bodies[owner];
+            if (b.m_body != m_body || b.n_body != n_body
+                    || b.stmts.size() != n_body) {
+                b.m_body = m_body;
+                b.n_body = n_body;
+                b.kinds.reset();
+                b.stmts.clear();
+                b.stmts.reserve(n_body);
+                for (size_t i = 0; i < n_body; i++) {
+                    b.stmts.push_back(ASR::subtree_kinds(*m_body[i]));
+                    b.kinds |= b.stmts.back();
+                }
+            }
+            return b;
+        }
+
         void get_dim_rank(ASR::ttype_t* x_type, ASR::dimension_t*& m_dims, int& n_dims) {
             ASR::ttype_t* t2 = ASRUtils::type_get_past_pointer(x_type);
             switch( t2->type ) {
@@ -1,7 +1,11 @@
 #ifndef LFORTRAN_PASS_UTILS_H
 #define LFORTRAN_PASS_UTILS_H
 
+#include <unordered_map>
+#include <vector>
+
 #include <libasr/asr.h>
+#include <libasr/asr_utils.h>
 #include <libasr/containers.h>
 
 namespace LFortran {
@@ -67,6 +71,59 @@ namespace LFortran {
         Vec<ASR::stmt_t*> replace_doloop(Allocator &al, const ASR::DoLoop_t &loop,
                                          int comp=-1);
 
+        // The kinds of the statements of the bodies of programs, functions,
+        // subroutines and associate blocks (see ASR::SubtreeKinds), computed
+        // when first needed. The PassManager shares one between its passes, so
+        // that a PassVisitor can skip the bodies and statements that contain
+        // nothing it rewrites. PassVisitor::transform_body() keeps it up to
+        // date, passes that change bodies in other ways must clear() it.
+        class SubtreeKindsCache {
+            public:
+
+                struct Body {
+                    ASR::stmt_t **m_body = nullptr;
+                    size_t n_body = 0;
+                    ASR::SubtreeKinds kinds; // Of the whole body
+                    std::vector<ASR::SubtreeKinds> stmts; // Of each statement
+                };
+
+                SubtreeKindsCache() {}
+                SubtreeKindsCache(const SubtreeKindsCache&) = delete;
+                SubtreeKindsCache& operator=(const SubtreeKindsCache&) = delete;
+
+                // Makes `cache` the SubtreeKindsCache of the current thread
+                // for its lifetime
+                class Scope {
+                    SubtreeKindsCache *previous;
+                public:
+                    Scope(SubtreeKindsCache &cache);
+                    ~Scope();
+                    Scope(const Scope&) = delete;
+                    Scope& operator=(const Scope&) = delete;
+                };
+
+                // The SubtreeKindsCache of the current thread, nullptr if
+                // there is none
+                static SubtreeKindsCache* current();
+
+                // The kinds of the body `m_body` of `owner`, computed if they
+                // are not known yet or the body was replaced since
+                Body& get(const ASR::asr_t *owner, ASR::stmt_t **m_body,
+                    size_t n_body);
+
+                void invalidate(const ASR::asr_t *owner) {
+                    bodies.erase(owner);
+                }
+
+                void clear() {
+                    bodies.clear();
+                }
+
+            private:
+                // The references stay valid when other bodies are added
+                std::unordered_map<const ASR::asr_t*, Body> bodies;
+        };
+
         template <class Derived>
         class PassVisitor: public ASR::BaseWalkVisitor<Derived> {
 
@@ -74,6 +131,19 @@ namespace LFortran {
 
                 Derived& self() { return static_cast<Derived&>(*this); }
 
+                // The kinds of the statements of the body that the next
+                // transform_stmts() transforms, see transform_body()
+                std::vector<ASR::SubtreeKinds> *body_kinds = nullptr;
+
+                // Appends the kinds of the statements of `body` that are not
+                // in `kinds` yet
+                static void add_kinds(std::vector<ASR::SubtreeKinds> &kinds,
+                        const Vec<ASR::stmt_t*> &body) {
+                    while (kinds.size() < body.size()) {
+                        kinds.push_back(ASR::subtree_kinds(*body[kinds.size()]));
+                    }
+                }
+
             public:
 
                 bool asr_changed, retain_original_stmt, remove_original_stmt;
@@ -86,7 +156,46 @@ namespace LFortran {
                     pass_result.n = 0;
                 }
 
+                // The statement and expression kinds that the pass rewrites.
+                // transform_body() skips the statements that contain none of
+                // them. All kinds by default, so that nothing is skipped.
+                ASR::SubtreeKinds relevant_kinds() {
+                    return ASR::all_kinds();
+                }
+
+                // Transforms the body of `owner` with transform_stmts(), only
+                // visiting the statements that contain relevant_kinds() if a
+                // SubtreeKindsCache is current
+                void transform_body(const ASR::asr_t *owner,
+                        ASR::stmt_t **&m_body, size_t &n_body) {
+                    SubtreeKindsCache *cache = SubtreeKindsCache::current();
+                    ASR::SubtreeKinds relevant = self().relevant_kinds();
+                    if (!cache || relevant.all()) {
+                        // Any statement might change, the kinds are computed
+                        // again when a pass needs them
+                        if (cache) cache->invalidate(owner);
+                        transform_stmts(m_body, n_body);
+                        return;
+                    }
+                    SubtreeKindsCache::Body &b = cache->get(owner, m_body, n_body);
+                    if ((b.kinds & relevant).none()) return;
+                    body_kinds = &b.stmts;
+                    transform_stmts(m_body, n_body);
+                    b.m_body = m_body;
+                    b.n_body = n_body;
+                    b.kinds.reset();
+                    for (auto &k : b.stmts) b.kinds |= k;
+                }
+
                 void transform_stmts(ASR::stmt_t **&m_body, size_t &n_body) {
+                    std::vector<ASR::SubtreeKinds> *kinds = body_kinds;
+                    body_kinds = nullptr;
+                    std::vector<ASR::SubtreeKinds> new_kinds;
+                    ASR::SubtreeKinds relevant;
+                    if (kinds) {
+                        new_kinds.reserve(n_body);
+                        relevant = self().relevant_kinds();
+                    }
                     Vec<ASR::stmt_t*> body;
                     body.reserve(al, n_body);
                     if (pass_result.size() > 0) {
@@ -95,8 +204,14 @@ namespace LFortran {
                             body.push_back(al, pass_result[j]);
                         }
                         pass_result.n = 0;
+                        if (kinds) add_kinds(new_kinds, body);
                     }
                     for (size_t i=0; i<n_body; i++) {
+                        if (kinds && ((*kinds)[i] & relevant).none()) {
+                            body.push_back(al, m_body[i]);
+                            new_kinds.push_back((*kinds)[i]);
+                            continue;
+                        }
                         // Not necessary after we check it after each visit_stmt in every
                         // visitor method:
                         pass_result.n = 0;
@@ -116,7 +231,10 @@ namespace LFortran {
                         } else if(!remove_original_stmt) {
                             body.push_back(al, m_body[i]);
                         }
+                        // The visited statement may have been changed
+                        if (kinds) add_kinds(new_kinds, body);
                     }
+                    if (kinds) kinds->swap(new_kinds);
                     m_body = body.p;
                     n_body = body.size();
                 }
@@ -126,7 +244,7 @@ namespace LFortran {
                     // which requires to generate a TransformVisitor.
                     ASR::Program_t &xx = const_cast<ASR::Program_t&>(x);
                     current_scope = xx.m_symtab;
-                    transform_stmts(xx.m_body, xx.n_body);
+                    transform_body(&xx.base.base, xx.m_body, xx.n_body);
 
                     // Transform nested functions and subroutines
                     for (auto &item : x.m_symtab->get_scope()) {
@@ -150,7 +268,7 @@ namespace LFortran {
                     // which requires to generate a TransformVisitor.
                     ASR::Subroutine_t &xx = const_cast<ASR::Subroutine_t&>(x);
                     current_scope = xx.m_symtab;
-                    transform_stmts(xx.m_body, xx.n_body);
+                    transform_body(&xx.base.base, xx.m_body, xx.n_body);
                 }
 
                 void visit_Function(const ASR::Function_t &x) {
@@ -158,13 +276,13 @@ namespace LFortran {
                     // which requires to generate a TransformVisitor.
                     ASR::Function_t &xx = const_cast<ASR::Function_t&>(x);
                     current_scope = xx.m_symtab;
-                    transform_stmts(xx.m_body, xx.n_body);
+                    transform_body(&xx.base.base, xx.m_body, xx.n_body);
                 }
 
                 void visit_AssociateBlock(const ASR::AssociateBlock_t& x) {
                     ASR::AssociateBlock_t &xx = const_cast<ASR::AssociateBlock_t&>(x);
                     current_scope = xx.m_symtab;
-                    transform_stmts(xx.m_body, xx.n_body);
+                    transform_body(&xx.base.base, xx.m_body, xx.n_body);
                 }
 
         };
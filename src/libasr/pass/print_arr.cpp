@@ -38,6 +38,10 @@ public:
 
     }
 
+    ASR::SubtreeKinds relevant_kinds() {
+        return ASR::kinds_of(ASR::stmtType::Print);
+    }
+
     void visit_Print(const ASR::Print_t& x) {
         if( x.n_values == 1 && PassUtils::is_array(x.m_values[0]) ) {
             ASR::expr_t* arr_expr = x.m_values[0];
@@ -153,6 +153,10 @@ public:
     SelectCaseVisitor(Allocator &al) : PassVisitor(al, nullptr) {
     }
 
+    ASR::SubtreeKinds relevant_kinds() {
+        return ASR::kinds_of(ASR::stmtType::Select);
+    }
+
     void visit_WhileLoop(const ASR::WhileLoop_t &x) {
         // FIXME: this is a hack, we need to pass in a non-const `x`,
         // which requires to generate a TransformVisitor.
@@ -192,12 +192,12 @@ public:
 
     void remove_unused_fn(SymbolTable* symtab) {
         std::vector<std::string> to_be_erased;
-        for (auto it = symtab->get_scope().begin(); it != symtab->get_scope().end(); ++it) {
-            uint64_t h = get_hash((ASR::asr_t*)it->second);
+        for (auto &item : symtab->get_scope()) {
+            uint64_t h = get_hash((ASR::asr_t*)item.second);
             if (fn_unused.find(h) != fn_unused.end()) {
-                to_be_erased.push_back(it->first);
+                to_be_erased.push_back(item.first);
             } else {
-                this->visit_symbol(*it->second);
+                this->visit_symbol(*item.second);
             }
         }
 
@@ -1,4 +1,9 @@
+#include <algorithm>
+#include <cstring>
+#include <iterator>
 #include <string>
+#include <tuple>
+#include <unordered_map>
 
 #include <libasr/config.h>
 #include <libasr/serialization.h>
@@ -12,13 +17,16 @@ using LFortran::ASRUtils::symbol_name;
 
 namespace LFortran {
 
+// Written in front of the compact binary ASR, so that deserialize_asr() can
+// reject ASR saved in an older format
+const std::string asr_binary_magic = "LPASR\x01";
 
+// The ASR is saved in the compact binary format (see CompactBinaryWriter).
+// Most integers are locations, symbol table IDs and counts and fit into one
+// to three bytes, and the names of the symbols (written by every reference
+// to a symbol) are only stored once in the string table.
 class ASRSerializationVisitor :
-#ifdef WITH_LFORTRAN_BINARY_MODFILES
-        public BinaryWriter,
-#else
-        public TextWriter,
-#endif
+        public CompactBinaryWriter,
         public ASR::SerializationBaseVisitor<ASRSerializationVisitor>
 {
 public:
@@ -41,30 +49,27 @@ std::string serialize(const ASR::asr_t &asr) {
     ASRSerializationVisitor v;
     v.write_int8(asr.type);
     v.visit_asr(asr);
-    return v.get_str();
+    return asr_binary_magic + v.get_str();
 }
 
 std::string serialize(const ASR::TranslationUnit_t &unit) {
     return serialize((ASR::asr_t&)(unit));
 }
 
+// Decodes the compact binary ASR straight from the input. Each string of the
+// string table is copied into the Allocator once, all its occurrences share
+// the copy.
 class ASRDeserializationVisitor :
-#ifdef WITH_LFORTRAN_BINARY_MODFILES
-        public BinaryReader,
-#else
-        public TextReader,
-#endif
+        public CompactBinaryReader,
         public ASR::DeserializationBaseVisitor<ASRDeserializationVisitor>
 {
+    std::vector<char*> cstrings;
 public:
-    ASRDeserializationVisitor(Allocator &al, const std::string &s,
+    ASRDeserializationVisitor(Allocator &al, std::string_view s,
         bool load_symtab_id) :
-#ifdef WITH_LFORTRAN_BINARY_MODFILES
-            BinaryReader(s),
-#else
-            TextReader(s),
-#endif
-            DeserializationBaseVisitor(al, load_symtab_id) {}
+            CompactBinaryReader(s),
+            DeserializationBaseVisitor(al, load_symtab_id),
+            cstrings(n_strings(), nullptr) {}
 
     bool read_bool() {
         uint8_t b = read_int8();
@@ -72,11 +77,15 @@ public:
     }
 
     char* read_cstring() {
-        std::string s = read_string();
-        LFortran::Str cs;
-        cs.from_str_view(s);
-        char* p = cs.c_str(al);
-        return p;
+        size_t id = read_string_id();
+        if (!cstrings[id]) {
+            std::string_view s = get_string(id);
+            char *p = al.allocate<char>(s.size() + 1);
+            std::memcpy(p, s.data(), s.size());
+            p[s.size()] = '\0';
+            cstrings[id] = p;
+        }
+        return cstrings[id];
     }
 
 // FIXME LOCATION: document if this is just initialization that will
@@ -321,9 +330,13 @@ void fix_external_symbols(ASR::TranslationUnit_t &unit,
     e.visit_TranslationUnit(unit);
 }
 
-ASR::asr_t* deserialize_asr(Allocator &al, const std::string &s,
+ASR::asr_t* deserialize_asr(Allocator &al, std::string_view s,
         bool load_symtab_id, SymbolTable &external_symtab) {
-    ASRDeserializationVisitor v(al, s, load_symtab_id);
+    if (s.substr(0, asr_binary_magic.size()) != asr_binary_magic) {
+        throw LFortranException("ASR binary format not recognized");
+    }
+    ASRDeserializationVisitor v(al, s.substr(asr_binary_magic.size()),
+        load_symtab_id);
     ASR::asr_t *node = v.deserialize_node();
     ASR::TranslationUnit_t *tu = ASR::down_cast2<ASR::TranslationUnit_t>(node);
 
@@ -340,4 +353,439 @@ ASR::asr_t* deserialize_asr(Allocator &al, const std::string &s,
     return node;
 }
 
+
+// Written in front of an ASR image, see save_asr_image()
+const std::string asr_image_magic = "LPIMG\x01";
+
+// Copies the ASR into an image, in which each pointer is the offset of its
+// target from the start of the image. The offsets of all pointers are
+// recorded, so that the loader only adds the address of the image to them.
+// Symbol tables are not copied, but recorded as lists of names and symbols
+// and rebuilt by the loader. The bodies of the functions of a module are
+// written last, each with its own pointers, so that the loader can leave
+// them to be relocated when they are used (see load_asr_image_body()).
+class ASRImageWriter : public ASR::ImageBaseVisitor<ASRImageWriter>
+{
+public:
+    struct SymbolTableRecord {
+        uint32_t parent; // An index of `symtabs`, or `no_parent`
+        uint32_t owner; // The offset of the node that owns it
+        uint32_t counter;
+        std::vector<std::pair<uint32_t, uint32_t>> symbols; // name, symbol
+    };
+    static const uint32_t no_parent = UINT32_MAX;
+
+    struct BodyRecord {
+        uint32_t function; // The offset of the Function or Subroutine
+        uint32_t body; // The offset of the array of statements
+        uint32_t n_body;
+        uint32_t pointers_begin, pointers_end; // A range of `pointers`
+    };
+
+    std::string image;
+    std::vector<uint32_t> pointers; // The offsets of the pointers
+    std::vector<std::pair<uint32_t, uint32_t>> symtab_pointers; // offset, index
+    std::vector<SymbolTableRecord> symtabs;
+    std::vector<BodyRecord> bodies;
+
+private:
+    std::unordered_map<const void*, size_t> nodes;
+    // The nodes of the body being written, which only it points to
+    std::unordered_map<const void*, size_t> body_nodes;
+    bool writing_body = false;
+    // The function offset and its body, written by finish()
+    std::vector<std::tuple<size_t, ASR::stmt_t**, size_t>> deferred_bodies;
+    std::unordered_map<std::string, size_t> strings;
+    std::unordered_map<const SymbolTable*, uint32_t> symtab_ids;
+    std::vector<uint32_t> symtab_stack; // The symbol tables being written
+    std::vector<std::pair<size_t, const ASR::symbol_t*>> symbol_refs;
+    std::vector<std::pair<size_t, const SymbolTable*>> symtab_refs;
+
+public:
+    size_t allocate(size_t n) {
+        size_t o = align(image.size());
+        image.resize(o + n, '\0');
+        return o;
+    }
+
+    bool find_node(const void *x, size_t &o) {
+        auto it = nodes.find(x);
+        if (it == nodes.end()) {
+            it = body_nodes.find(x);
+            if (it == body_nodes.end()) return false;
+        }
+        o = it->second;
+        return true;
+    }
+
+    void add_node(const void *x, size_t o) {
+        if (writing_body) {
+            body_nodes[x] = o;
+        } else {
+            nodes[x] = o;
+        }
+    }
+
+    // The functions of a module are written without their body, which
+    // finish() writes
+    bool defer_body(const SymbolTable &symtab, ASR::deftypeType deftype,
+            size_t n_body) {
+        const SymbolTable *parent = symtab.parent;
+        return deftype == ASR::deftypeType::Implementation && n_body > 0
+            && parent && parent->asr_owner
+            && ASR::is_a<ASR::symbol_t>(*parent->asr_owner)
+            && ASR::is_a<ASR::Module_t>(
+                *ASR::down_cast<ASR::symbol_t>(parent->asr_owner));
+    }
+
+    void image_Function(const ASR::Function_t &x, size_t o) {
+        if (!defer_body(*x.m_symtab, x.m_deftype, x.n_body)) {
+            ImageBaseVisitor::image_Function(x, o);
+            return;
+        }
+        ASR::Function_t y = x;
+        y.m_body = nullptr;
+        y.n_body = 0;
+        ImageBaseVisitor::image_Function(y, o);
+        deferred_bodies.push_back({o, x.m_body, x.n_body});
+    }
+
+    void image_Subroutine(const ASR::Subroutine_t &x, size_t o) {
+        if (!defer_body(*x.m_symtab, x.m_deftype, x.n_body)) {
+            ImageBaseVisitor::image_Subroutine(x, o);
+            return;
+        }
+        ASR::Subroutine_t y = x;
+        y.m_body = nullptr;
+        y.n_body = 0;
+        ImageBaseVisitor::image_Subroutine(y, o);
+        deferred_bodies.push_back({o, x.m_body, x.n_body});
+    }
+
+    template <typename T>
+    void copy_value(size_t slot, const T &value) {
+        std::memcpy(&image[slot], &value, sizeof(T));
+    }
+
+    void set_pointer(size_t slot, size_t target) {
+        copy_value(slot, (uintptr_t)target);
+        pointers.push_back(slot);
+    }
+
+    size_t write_string(const char *s) {
+        auto r = strings.try_emplace(s, image.size());
+        if (r.second) image.append(s, std::strlen(s) + 1);
+        return r.first->second;
+    }
+
+    // The referenced symbol can be written later, see finish()
+    void set_symbol_ref(size_t slot, const ASR::symbol_t *s) {
+        if (writing_body) {
+            resolve_symbol_ref(slot, s);
+        } else {
+            symbol_refs.push_back({slot, s});
+        }
+    }
+
+    void resolve_symbol_ref(size_t slot, const ASR::symbol_t *s) {
+        size_t o;
+        if (!find_node(s, o)) {
+            throw LFortranException("The symbol '"
+                + std::string(symbol_name(s))
+                + "' is referenced, but it is not in the saved ASR");
+        }
+        set_pointer(slot, o);
+    }
+
+    void set_symtab(size_t slot, const SymbolTable &symtab, size_t owner) {
+        if (writing_body) {
+            throw LFortranException("A function body with a symbol table cannot be saved in an image");
+        }
+        uint32_t id = symtabs.size();
+        symtab_ids[&symtab] = id;
+        symtab_pointers.push_back({slot, id});
+        SymbolTableRecord r;
+        // Like FixParentSymtabVisitor, the parent is the enclosing table in
+        // the saved tree, not `symtab.parent`
+        r.parent = symtab_stack.empty() ? no_parent : symtab_stack.back();
+        r.owner = owner;
+        r.counter = symtab.counter;
+        symtabs.push_back(r);
+        symtab_stack.push_back(id);
+        for (auto &a : symtab.get_scope()) {
+            size_t name = write_string(a.first.c_str());
+            size_t sym = image_symbol(*a.second);
+            symtabs[id].symbols.push_back({name, sym});
+        }
+        symtab_stack.pop_back();
+    }
+
+    void set_symtab_ref(size_t slot, const SymbolTable *symtab) {
+        symtab_refs.push_back({slot, symtab});
+    }
+
+    // Resolves the references, once all nodes and symbol tables are written,
+    // then writes the deferred bodies, which can point to any of them
+    void finish() {
+        for (auto &r : symbol_refs) {
+            resolve_symbol_ref(r.first, r.second);
+        }
+        writing_body = true;
+        for (auto &d : deferred_bodies) {
+            ASR::stmt_t **body = std::get<1>(d);
+            size_t n_body = std::get<2>(d);
+            body_nodes.clear();
+            BodyRecord r;
+            r.function = std::get<0>(d);
+            r.n_body = n_body;
+            r.pointers_begin = pointers.size();
+            r.body = allocate(n_body * sizeof(ASR::stmt_t*));
+            for (size_t i=0; i < n_body; i++) {
+                set_pointer(r.body + i*sizeof(ASR::stmt_t*),
+                    image_stmt(*body[i]));
+            }
+            r.pointers_end = pointers.size();
+            bodies.push_back(r);
+        }
+        writing_body = false;
+        for (auto &r : symtab_refs) {
+            auto it = symtab_ids.find(r.second);
+            if (it == symtab_ids.end()) {
+                throw LFortranException("A symbol table is referenced, but it is not in the saved ASR");
+            }
+            symtab_pointers.push_back({r.first, it->second});
+        }
+        if (image.size() > UINT32_MAX) {
+            throw LFortranException("The ASR is too large for an image");
+        }
+    }
+};
+
+namespace {
+
+void write_uint32(std::string &s, uint32_t i) {
+    s.append((const char*)&i, sizeof(i));
+}
+
+void write_uint64(std::string &s, uint64_t i) {
+    s.append((const char*)&i, sizeof(i));
+}
+
+// Reads the values written by write_uint32() and write_uint64()
+class ImageReader {
+    std::string_view s;
+    size_t pos = 0;
+public:
+    ImageReader(std::string_view s) : s{s} {}
+
+    template <typename T>
+    T read() {
+        if (pos + sizeof(T) > s.size()) {
+            throw LFortranException("ASR image is truncated");
+        }
+        T i;
+        std::memcpy(&i, s.data() + pos, sizeof(T));
+        pos += sizeof(T);
+        return i;
+    }
+
+    std::string_view read_bytes(size_t n) {
+        if (n > s.size() - pos) {
+            throw LFortranException("ASR image is truncated");
+        }
+        std::string_view r = s.substr(pos, n);
+        pos += n;
+        return r;
+    }
+};
+
+// Checks that `n` bytes at the offset `o` are inside the image of `size`
+// bytes, so that a corrupted image throws instead of crashing
+void check_offset(uint64_t o, size_t n, size_t size) {
+    if (o > size || n > size - o) {
+        throw LFortranException("ASR image is corrupted");
+    }
+}
+
+// Adds the address of the image to the pointer at `slot`
+void relocate_pointer(char *base, uint32_t slot) {
+    uintptr_t p;
+    std::memcpy(&p, base + slot, sizeof(p));
+    p += (uintptr_t)base;
+    std::memcpy(base + slot, &p, sizeof(p));
+}
+
+} // namespace
+
+std::string save_asr_image(const ASR::TranslationUnit_t &unit) {
+    ASRImageWriter w;
+    size_t root = w.image_unit((const ASR::unit_t&)unit);
+    w.finish();
+    std::string s = asr_image_magic;
+    write_uint64(s, ASRImageWriter::layout_hash());
+    write_uint64(s, root);
+    write_uint64(s, w.image.size());
+    s.append(w.image);
+    write_uint64(s, w.pointers.size());
+    for (uint32_t p : w.pointers) write_uint32(s, p);
+    write_uint64(s, w.symtabs.size());
+    for (auto &t : w.symtabs) {
+        write_uint32(s, t.parent);
+        write_uint32(s, t.owner);
+        write_uint32(s, t.counter);
+        write_uint64(s, t.symbols.size());
+        for (auto &sym : t.symbols) {
+            write_uint32(s, sym.first);
+            write_uint32(s, sym.second);
+        }
+    }
+    write_uint64(s, w.symtab_pointers.size());
+    for (auto &p : w.symtab_pointers) {
+        write_uint32(s, p.first);
+        write_uint32(s, p.second);
+    }
+    write_uint64(s, w.bodies.size());
+    for (auto &b : w.bodies) {
+        write_uint32(s, b.function);
+        write_uint32(s, b.body);
+        write_uint32(s, b.n_body);
+        write_uint32(s, b.pointers_begin);
+        write_uint32(s, b.pointers_end);
+    }
+    return s;
+}
+
+ASR::TranslationUnit_t* load_asr_image(Allocator &al, std::string_view s,
+        bool load_symtab_id, std::vector<ASRImageBody> *lazy_bodies) {
+    if (s.substr(0, asr_image_magic.size()) != asr_image_magic) {
+        throw LFortranException("ASR image format not recognized");
+    }
+    ImageReader r(s.substr(asr_image_magic.size()));
+    if (r.read<uint64_t>() != ASRImageWriter::layout_hash()) {
+        throw LFortranException("ASR image was saved by a compiler with a different ASR layout");
+    }
+    uint64_t root = r.read<uint64_t>();
+    uint64_t size = r.read<uint64_t>();
+    std::string_view image = r.read_bytes(size);
+    check_offset(root, sizeof(ASR::TranslationUnit_t), size);
+
+    // The only copy, all strings and arrays stay in the image
+    char *base = al.allocate<char>(size);
+    std::memcpy(base, image.data(), size);
+    uint64_t n_pointers = r.read<uint64_t>();
+    std::vector<uint32_t> pointers;
+    pointers.reserve(std::min<uint64_t>(n_pointers, size));
+    for (uint64_t i=0; i < n_pointers; i++) {
+        uint32_t slot = r.read<uint32_t>();
+        check_offset(slot, sizeof(uintptr_t), size);
+        uintptr_t p;
+        std::memcpy(&p, base + slot, sizeof(p));
+        check_offset(p, 0, size);
+        pointers.push_back(slot);
+    }
+
+    uint64_t n_symtabs = r.read<uint64_t>();
+    std::vector<SymbolTable*> symtabs;
+    for (uint64_t i=0; i < n_symtabs; i++) {
+        uint32_t parent = r.read<uint32_t>();
+        uint32_t owner = r.read<uint32_t>();
+        uint32_t counter = r.read<uint32_t>();
+        if (parent != ASRImageWriter::no_parent && parent >= i) {
+            throw LFortranException("ASR image is corrupted");
+        }
+        check_offset(owner, sizeof(ASR::asr_t), size);
+        SymbolTable *symtab = al.make_new<SymbolTable>(
+            parent == ASRImageWriter::no_parent ? nullptr : symtabs[parent]);
+        symtab->asr_owner = (ASR::asr_t*)(base + owner);
+        if (load_symtab_id) symtab->counter = counter;
+        uint64_t n_symbols = r.read<uint64_t>();
+        for (uint64_t j=0; j < n_symbols; j++) {
+            uint32_t name = r.read<uint32_t>();
+            uint32_t sym = r.read<uint32_t>();
+            check_offset(name, 1, size);
+            check_offset(sym, sizeof(ASR::symbol_t), size);
+            if (!std::memchr(base + name, '\0', size - name)) {
+                throw LFortranException("ASR image is corrupted");
+            }
+            symtab->add_symbol(base + name, (ASR::symbol_t*)(base + sym));
+        }
+        symtabs.push_back(symtab);
+    }
+    uint64_t n_symtab_pointers = r.read<uint64_t>();
+    for (uint64_t i=0; i < n_symtab_pointers; i++) {
+        uint32_t slot = r.read<uint32_t>();
+        uint32_t index = r.read<uint32_t>();
+        check_offset(slot, sizeof(SymbolTable*), size);
+        if (index >= symtabs.size()) {
+            throw LFortranException("ASR image is corrupted");
+        }
+        std::memcpy(base + slot, &symtabs[index], sizeof(SymbolTable*));
+    }
+
+    // The pointers of the bodies follow the others, body by body
+    uint64_t n_bodies = r.read<uint64_t>();
+    std::vector<ASRImageBody> bodies;
+    uint64_t n_main_pointers = n_pointers, pointers_end = n_pointers;
+    for (uint64_t i=0; i < n_bodies; i++) {
+        uint32_t function = r.read<uint32_t>();
+        uint32_t body = r.read<uint32_t>();
+        uint32_t n_body = r.read<uint32_t>();
+        uint32_t begin = r.read<uint32_t>();
+        uint32_t end = r.read<uint32_t>();
+        check_offset(function, std::max(sizeof(ASR::Function_t),
+            sizeof(ASR::Subroutine_t)), size);
+        check_offset(body, (uint64_t)n_body * sizeof(ASR::stmt_t*), size);
+        if (i == 0) {
+            n_main_pointers = begin;
+            pointers_end = begin;
+        }
+        if (begin != pointers_end || begin > end || end > n_pointers) {
+            throw LFortranException("ASR image is corrupted");
+        }
+        pointers_end = end;
+        ASR::asr_t *f = (ASR::asr_t*)(base + function);
+        if (f->type != ASR::asrType::symbol
+                || !(ASR::is_a<ASR::Function_t>(*(ASR::symbol_t*)f)
+                    || ASR::is_a<ASR::Subroutine_t>(*(ASR::symbol_t*)f))) {
+            throw LFortranException("ASR image is corrupted");
+        }
+        ASRImageBody b;
+        b.function = (ASR::symbol_t*)f;
+        b.base = base;
+        b.body = body;
+        b.n_body = n_body;
+        b.pointers.assign(pointers.begin() + begin, pointers.begin() + end);
+        bodies.push_back(std::move(b));
+    }
+    if (pointers_end != n_pointers) {
+        throw LFortranException("ASR image is corrupted");
+    }
+    for (uint64_t i=0; i < n_main_pointers; i++) {
+        relocate_pointer(base, pointers[i]);
+    }
+    if (lazy_bodies) {
+        std::move(bodies.begin(), bodies.end(),
+            std::back_inserter(*lazy_bodies));
+    } else {
+        for (auto &b : bodies) load_asr_image_body(b);
+    }
+    return (ASR::TranslationUnit_t*)(base + root);
+}
+
+void load_asr_image_body(const ASRImageBody &b) {
+    for (uint32_t slot : b.pointers) {
+        relocate_pointer(b.base, slot);
+    }
+    ASR::stmt_t **body = (ASR::stmt_t**)(b.base + b.body);
+    if (ASR::is_a<ASR::Function_t>(*b.function)) {
+        ASR::Function_t *f = ASR::down_cast<ASR::Function_t>(b.function);
+        f->m_body = body;
+        f->n_body = b.n_body;
+    } else {
+        ASR::Subroutine_t *f = ASR::down_cast<ASR::Subroutine_t>(b.function);
+        f->m_body = body;
+        f->n_body = b.n_body;
+    }
+}
+
 } // namespace LFortran
@@ -1,17 +1,45 @@
 #ifndef LIBASR_SERIALIZATION_H
 #define LIBASR_SERIALIZATION_H
 
+#include <string_view>
+#include <vector>
+
 #include <libasr/asr.h>
 
 namespace LFortran {
 
     std::string serialize(const ASR::asr_t &asr);
     std::string serialize(const ASR::TranslationUnit_t &unit);
-    ASR::asr_t* deserialize_asr(Allocator &al, const std::string &s,
+    ASR::asr_t* deserialize_asr(Allocator &al, std::string_view s,
             bool load_symtab_id, SymbolTable &symtab);
 
     void fix_external_symbols(ASR::TranslationUnit_t &unit,
             SymbolTable &external_symtab);
+
+    // Saves the ASR as an image in which the pointers are offsets, which
+    // load_asr_image() copies into the Allocator and relocates without
+    // rebuilding the nodes. Unlike serialize(), the image depends on the
+    // memory layout of the nodes, it can only be loaded by the same build of
+    // the compiler. The ExternalSymbols must be fixed after loading (see
+    // fix_external_symbols()).
+    std::string save_asr_image(const ASR::TranslationUnit_t &unit);
+
+    // The body of a function of a module in an image, which stays empty
+    // until load_asr_image_body() relocates it
+    struct ASRImageBody {
+        ASR::symbol_t *function; // A Function or a Subroutine
+        char *base; // The loaded image
+        uint32_t body; // The offset of the statements
+        size_t n_body;
+        std::vector<uint32_t> pointers; // The offsets of their pointers
+    };
+
+    // If `lazy_bodies` is not null, the bodies of the functions of the
+    // modules are appended to it instead of being loaded
+    ASR::TranslationUnit_t* load_asr_image(Allocator &al, std::string_view s,
+            bool load_symtab_id,
+            std::vector<ASRImageBody> *lazy_bodies=nullptr);
+    void load_asr_image_body(const ASRImageBody &body);
 }
 
 #endif // LIBASR_SERIALIZATION_H
@@ -0,0 +1,141 @@
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifndef _WIN32
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <unistd.h>
+#endif
+
+#include <libasr/source_manager.h>
+#include <libasr/utils.h>
+
+#if defined(_WIN32) && !defined(S_ISREG)
+#  define S_ISREG(m) (((m) & S_IFMT) == S_IFREG)
+#endif
+
+namespace LFortran {
+
+namespace {
+
+// Files smaller than this are read, mapping them costs more than copying
+const size_t mmap_threshold = 64*1024;
+
+bool file_stat(const std::string &filename, int64_t &mtime,
+        int64_t &file_size) {
+    struct stat st;
+    if (stat(filename.c_str(), &st) != 0) return false;
+    if (!S_ISREG(st.st_mode)) return false;
+#if defined(__linux__)
+    mtime = (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+#elif defined(__APPLE__)
+    mtime = (int64_t)st.st_mtimespec.tv_sec * 1000000000
+        + st.st_mtimespec.tv_nsec;
+#else
+    mtime = (int64_t)st.st_mtime;
+#endif
+    file_size = st.st_size;
+    return true;
+}
+
+} // namespace
+
+SourceFile::~SourceFile() {
+#ifndef _WIN32
+    if (mapped_size > 0) {
+        munmap((void*)data, mapped_size);
+    }
+#endif
+}
+
+std::unique_ptr<SourceFile> SourceFile::open(const std::string &filename) {
+    std::unique_ptr<SourceFile> f(new SourceFile());
+    if (!file_stat(filename, f->mtime, f->file_size)) return nullptr;
+    size_t n = f->file_size;
+#ifndef _WIN32
+    if (n >= mmap_threshold) {
+        // Reserve the file size plus the '\n' and '\0' padding, and map the
+        // file over the start of it. The bytes past the end of the file are
+        // zero, so only the '\n' has to be written (which copies just the
+        // last page of a private mapping).
+        long page_size = sysconf(_SC_PAGESIZE);
+        size_t mapped_size = (n + 2 + page_size - 1) / page_size * page_size;
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) return nullptr;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || (size_t)st.st_size != n) {
+            // The file changed since stat()
+            ::close(fd);
+            return nullptr;
+        }
+        // A mapping shows the changes of the file on disk and faults
+        // (SIGBUS) if it is truncated, so only the files that nobody can
+        // write to are mapped
+        bool read_only = (st.st_mode & (S_IWUSR | S_IWGRP | S_IWOTH)) == 0;
+        void *p = !read_only ? MAP_FAILED : mmap(nullptr, mapped_size,
+            PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p != MAP_FAILED && mmap(p, n, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_FIXED, fd, 0) != MAP_FAILED) {
+            ::close(fd);
+            char *data = (char*)p;
+            f->size = n;
+            if (data[n-1] != '\n') data[f->size++] = '\n';
+            mprotect(p, mapped_size, PROT_READ);
+            f->data = data;
+            f->mapped_size = mapped_size;
+            return f;
+        }
+        // Fall back to reading the file
+        if (p != MAP_FAILED) munmap(p, mapped_size);
+        ::close(fd);
+    }
+#endif
+    if (!read_file(filename, f->buffer)) return nullptr;
+    if (f->buffer.empty() || f->buffer.back() != '\n') f->buffer += '\n';
+    f->data = f->buffer.c_str();
+    f->size = f->buffer.size();
+    return f;
+}
+
+bool SourceManager::get_file(const std::string &filename,
+        std::string_view &text) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = files.find(filename);
+    if (it != files.end()) {
+        int64_t mtime, file_size;
+        if (file_stat(filename, mtime, file_size)
+                && mtime == it->second->mtime
+                && file_size == it->second->file_size) {
+            text = it->second->text();
+            return true;
+        }
+        stale_files.push_back(std::move(it->second));
+        files.erase(it);
+    }
+    std::unique_ptr<SourceFile> f = SourceFile::open(filename);
+    if (!f) return false;
+    text = f->text();
+    files[filename] = std::move(f);
+    return true;
+}
+
+void SourceManager::release_stale_files() {
+    std::lock_guard<std::mutex> lock(mutex);
+    stale_files.clear();
+}
+
+size_t SourceManager::num_stale_files() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stale_files.size();
+}
+
+bool SourceManager::file_exists(const std::string &filename) {
+    int64_t mtime, file_size;
+    return file_stat(filename, mtime, file_size);
+}
+
+SourceManager &get_source_manager() {
+    static SourceManager sm;
+    return sm;
+}
+
+} // namespace LFortran
@@ -0,0 +1,83 @@
+#ifndef LFORTRAN_SOURCE_MANAGER_H
+#define LFORTRAN_SOURCE_MANAGER_H
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace LFortran {
+
+// The contents of a source file, read once. The text always ends with '\n'
+// (one is appended if the file does not end with it) and is followed by '\0',
+// so that it can be passed to the tokenizer without a copy.
+//
+// Large files that are read-only (no write permission for anyone, such as
+// the installed runtime modules) are memory mapped. A mapping would show the
+// changes of a file while it is parsed and fault when the file is truncated,
+// so all other files are read into a buffer.
+class SourceFile {
+public:
+    SourceFile(const SourceFile &) = delete;
+    SourceFile &operator=(const SourceFile &) = delete;
+    ~SourceFile();
+
+    // Returns nullptr if the file cannot be read
+    static std::unique_ptr<SourceFile> open(const std::string &filename);
+
+    std::string_view text() const {
+        return std::string_view(data, size);
+    }
+
+private:
+    SourceFile() = default;
+
+    const char *data = nullptr;
+    size_t size = 0; // Without the terminating '\0'
+    size_t mapped_size = 0; // Zero if the text is in `buffer`
+    std::string buffer;
+    // Used to detect that the file changed on disk since it was read
+    int64_t mtime = 0;
+    int64_t file_size = 0;
+
+    friend class SourceManager;
+};
+
+// Owns the source files of a compilation, so that each file is only read
+// once and the parser, the LocationManager and the diagnostics all use the
+// same buffer. If a file changed on disk, get_file() reads it again and
+// keeps the old version, so that the buffers returned before stay valid (at
+// the same address and with the same text) until release_stale_files() is
+// called. All methods are thread safe.
+class SourceManager {
+public:
+    // Sets `text` to the contents of `filename` (see SourceFile). Returns false
+    // if the file cannot be read.
+    bool get_file(const std::string &filename, std::string_view &text);
+
+    // Frees the old versions of the files that changed on disk, which
+    // invalidates the buffers returned for them. A long running process (the
+    // language server) calls it when it uses no buffers, between requests.
+    void release_stale_files();
+
+    // The number of old versions that release_stale_files() would free
+    size_t num_stale_files();
+
+    // Returns true if `filename` exists, without reading it
+    static bool file_exists(const std::string &filename);
+
+private:
+    std::mutex mutex;
+    std::map<std::string, std::unique_ptr<SourceFile>> files;
+    // Files that changed on disk, kept alive for their outstanding buffers
+    std::vector<std::unique_ptr<SourceFile>> stale_files;
+};
+
+// The SourceManager shared by the whole compiler process
+SourceManager &get_source_manager();
+
+} // namespace LFortran
+
+#endif // LFORTRAN_SOURCE_MANAGER_H
@@ -0,0 +1,130 @@
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+#include <libasr/string_interner.h>
+#include <libasr/assert.h>
+#include <libasr/exception.h>
+
+namespace LFortran {
+
+namespace {
+
+// The strings are copied into chunks of this size (or larger for long strings)
+const size_t min_chunk_size = 64*1024;
+
+} // namespace
+
+StringInterner::StringInterner() : shards{new Shard[n_shards]} {}
+
+size_t StringInterner::shard_index(std::string_view s) {
+    return std::hash<std::string_view>()(s) % n_shards;
+}
+
+const char *StringInterner::insert(Shard &shard, std::string_view s,
+        uint32_t &id) {
+    // Must be called with the unique lock held
+    auto it = shard.ids.find(s);
+    if (it != shard.ids.end()) {
+        id = it->second;
+        return shard.strings[id / n_shards];
+    }
+    if (shard.chunk_pos + s.size() + 1 > shard.chunk_size) {
+        shard.chunk_size = std::max(min_chunk_size, s.size() + 1);
+        shard.chunks.emplace_back(new char[shard.chunk_size]);
+        shard.chunk_pos = 0;
+    }
+    char *p = shard.chunks.back().get() + shard.chunk_pos;
+    std::memcpy(p, s.data(), s.size());
+    p[s.size()] = '\0';
+    shard.chunk_pos += s.size() + 1;
+    size_t index = shard.strings.size();
+    if (index >= UINT32_MAX / n_shards) {
+        throw LFortranException("StringInterner: Too many strings");
+    }
+    id = make_id(&shard - shards.get(), index);
+    shard.strings.push_back(p);
+    shard.sizes.push_back(s.size());
+    shard.ids[std::string_view(p, s.size())] = id;
+    return p;
+}
+
+uint32_t StringInterner::intern(std::string_view s) {
+    uint32_t id;
+    Shard &shard = shards[shard_index(s)];
+    {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.ids.find(s);
+        if (it != shard.ids.end()) return it->second;
+    }
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    insert(shard, s, id);
+    return id;
+}
+
+uint32_t StringInterner::intern(std::string_view s, const char *&str) {
+    uint32_t id;
+    Shard &shard = shards[shard_index(s)];
+    {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.ids.find(s);
+        if (it != shard.ids.end()) {
+            str = it->first.data();
+            return it->second;
+        }
+    }
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    str = insert(shard, s, id);
+    return id;
+}
+
+const char *StringInterner::intern_c_str(std::string_view s) {
+    uint32_t id;
+    Shard &shard = shards[shard_index(s)];
+    {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.ids.find(s);
+        if (it != shard.ids.end()) return it->first.data();
+    }
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    return insert(shard, s, id);
+}
+
+uint32_t StringInterner::find(std::string_view s) const {
+    const Shard &shard = shards[shard_index(s)];
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.ids.find(s);
+    if (it == shard.ids.end()) return not_found;
+    return it->second;
+}
+
+const char *StringInterner::c_str(uint32_t id) const {
+    const Shard &shard = shards[id % n_shards];
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    LFORTRAN_ASSERT(id / n_shards < shard.strings.size());
+    return shard.strings[id / n_shards];
+}
+
+std::string_view StringInterner::str(uint32_t id) const {
+    const Shard &shard = shards[id % n_shards];
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    LFORTRAN_ASSERT(id / n_shards < shard.strings.size());
+    return std::string_view(shard.strings[id / n_shards],
+        shard.sizes[id / n_shards]);
+}
+
+size_t StringInterner::size() const {
+    size_t n = 0;
+    for (size_t i=0; i < n_shards; i++) {
+        std::shared_lock<std::shared_mutex> lock(shards[i].mutex);
+        n += shards[i].strings.size();
+    }
+    return n;
+}
+
+StringInterner &get_string_interner() {
+    static StringInterner interner;
+    return interner;
+}
+
+} // namespace LFortran
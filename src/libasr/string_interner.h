@@ -0,0 +1,76 @@
+#ifndef LFORTRAN_STRING_INTERNER_H
+#define LFORTRAN_STRING_INTERNER_H
+
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace LFortran {
+
+// A table of unique strings (identifiers). Each distinct string is stored only
+// once and gets an integer ID, so that identifiers can be compared and looked
+// up as integers. The IDs depend on the order in which the strings were
+// interned, so they are only stable within a process and must not be
+// serialized. The interned strings are never freed and never move.
+//
+// The table is split into shards by the hash of the string, each with its own
+// lock, so that several threads can intern strings at the same time. All
+// methods are thread safe.
+class StringInterner {
+public:
+    // Returned by find() for a string that is not interned
+    static constexpr uint32_t not_found = UINT32_MAX;
+
+    StringInterner();
+    StringInterner(const StringInterner &) = delete;
+    StringInterner &operator=(const StringInterner &) = delete;
+
+    // Returns the ID of `s`, interning it first if needed
+    uint32_t intern(std::string_view s);
+    // As above, and sets `str` to the interned copy of `s`
+    uint32_t intern(std::string_view s, const char *&str);
+    // Returns the interned copy of `s` (null terminated), interning it first if
+    // needed. Equal strings return the same pointer.
+    const char *intern_c_str(std::string_view s);
+    // Returns the ID of `s`, or `not_found` if it was never interned
+    uint32_t find(std::string_view s) const;
+
+    // The interned string with the given `id` (null terminated)
+    const char *c_str(uint32_t id) const;
+    std::string_view str(uint32_t id) const;
+
+    // The number of interned strings
+    size_t size() const;
+
+private:
+    static constexpr size_t n_shards = 16;
+    struct Shard {
+        mutable std::shared_mutex mutex;
+        // The keys point to `strings`
+        std::unordered_map<std::string_view, uint32_t> ids;
+        std::vector<const char*> strings; // By index, see make_id()
+        std::vector<size_t> sizes;
+        std::vector<std::unique_ptr<char[]>> chunks;
+        size_t chunk_pos = 0;
+        size_t chunk_size = 0;
+    };
+    std::unique_ptr<Shard[]> shards;
+
+    // The shard is in the low bits of the ID, the index in the shard in the
+    // high bits
+    static uint32_t make_id(size_t shard, size_t index) {
+        return index * n_shards + shard;
+    }
+    static size_t shard_index(std::string_view s);
+    const char *insert(Shard &shard, std::string_view s, uint32_t &id);
+};
+
+// The StringInterner shared by the whole compiler process
+StringInterner &get_string_interner();
+
+} // namespace LFortran
+
+#endif // LFORTRAN_STRING_INTERNER_H
@@ -103,5 +103,55 @@ std::string read_file(const std::string &filename)
 }
 
 
+// This function is taken from:
+// https://github.com/aappleby/smhasher/blob/61a0530f28277f2e850bfc39600ce61d02b518de/src/MurmurHash2.cpp#L37
+uint32_t murmur_hash(const void * key, int len, uint32_t seed)
+{
+    // 'm' and 'r' are mixing constants generated offline.
+    // They're not really 'magic', they just happen to work well.
+    const uint32_t m = 0x5bd1e995;
+    const int r = 24;
+    // Initialize the hash to a 'random' value
+    uint32_t h = seed ^ len;
+    // Mix 4 bytes at a time into the hash
+    const unsigned char * data = (const unsigned char *)key;
+    while(len >= 4)
+    {
+        uint32_t k = *(uint32_t*)data;
+        k *= m;
+        k ^= k >> r;
+        k *= m;
+        h *= m;
+        h ^= k;
+        data += 4;
+        len -= 4;
+    }
+    // Handle the last few bytes of the input array
+    switch(len)
+    {
+        case 3: h ^= data[2] << 16; // fall through
+        case 2: h ^= data[1] << 8;  // fall through
+        case 1: h ^= data[0];
+            h *= m;
+    };
+    // Do a few final mixes of the hash to ensure the last few
+    // bytes are well-incorporated.
+    h ^= h >> 13;
+    h *= m;
+    h ^= h >> 15;
+    return h;
+}
+
+uint32_t murmur_hash_str(const std::string &s, uint32_t seed)
+{
+    return murmur_hash(&s[0], s.length(), seed);
+}
+
+uint32_t murmur_hash_int(uint64_t i, uint32_t seed)
+{
+    return murmur_hash(&i, 8, seed);
+}
+
+
 
 } // namespace LFortran
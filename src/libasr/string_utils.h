@@ -27,6 +27,11 @@ std::string replace(const std::string &s,
 
 std::string read_file(const std::string &filename);
 
+// MurmurHash2, a fast non-cryptographic hash with a stable value across runs
+uint32_t murmur_hash(const void *key, int len, uint32_t seed);
+uint32_t murmur_hash_str(const std::string &s, uint32_t seed);
+uint32_t murmur_hash_int(uint64_t i, uint32_t seed);
+
 } // namespace LFortran
 
 #endif // LFORTRAN_STRING_UTILS_H
@@ -0,0 +1,78 @@
+#ifndef LFORTRAN_THREAD_ALLOC_H
+#define LFORTRAN_THREAD_ALLOC_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <libasr/alloc.h>
+
+// Gives each thread its own Allocator, so that several threads can allocate
+// (e.g. create ASR nodes) at the same time, as Allocator itself is not thread
+// safe. Once the threads are done, absorb_into() hands the memory of all of
+// them over to a single Allocator, where it lives as long as that one does.
+//
+//     ThreadAllocators allocators;
+//     // On each thread:
+//     Allocator &al = allocators.get();
+//     ASR::make_...(al, ...);
+//     // After joining the threads:
+//     allocators.absorb_into(main_al);
+class ThreadAllocators
+{
+    size_t chunk_size;
+    uint64_t id; // Unique for each instance, see get()
+    std::mutex mutex;
+    std::vector<std::pair<std::thread::id, std::unique_ptr<Allocator>>>
+        allocators;
+
+    static uint64_t new_id() {
+        static std::atomic<uint64_t> next_id{0};
+        return ++next_id;
+    }
+public:
+    // `chunk_size` is the initial size of the Allocator of each thread
+    ThreadAllocators(size_t chunk_size=1024*1024)
+        : chunk_size{chunk_size}, id{new_id()} {}
+    ThreadAllocators(const ThreadAllocators&) = delete;
+    ThreadAllocators& operator=(const ThreadAllocators&) = delete;
+
+    // The Allocator of the calling thread, created on the first call
+    Allocator &get() {
+        // The last one used by this thread, to not lock for every call
+        thread_local uint64_t cached_id = 0;
+        thread_local Allocator *cached = nullptr;
+        if (cached_id == id) return *cached;
+        std::lock_guard<std::mutex> lock(mutex);
+        std::thread::id thread = std::this_thread::get_id();
+        Allocator *al = nullptr;
+        for (auto &a : allocators) {
+            if (a.first == thread) {
+                al = a.second.get();
+                break;
+            }
+        }
+        if (!al) {
+            allocators.emplace_back(thread,
+                std::make_unique<Allocator>(chunk_size));
+            al = allocators.back().second.get();
+        }
+        cached_id = id;
+        cached = al;
+        return *al;
+    }
+
+    // Moves the memory of all threads to `al`, once no thread uses its
+    // Allocator anymore. Later calls of get() create new Allocators.
+    void absorb_into(Allocator &al) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto &a : allocators) al.absorb(*a.second);
+        allocators.clear();
+        id = new_id();
+    }
+};
+
+#endif // LFORTRAN_THREAD_ALLOC_H
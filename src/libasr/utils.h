@@ -2,6 +2,7 @@
 #define LIBASR_UTILS_H
 
 #include <string>
+#include <string_view>
 #include <libasr/containers.h>
 
 namespace LFortran {
@@ -32,6 +33,9 @@ struct CompilerOptions {
     bool no_warnings = false;
     bool no_error_banner = false;
     bool new_parser = false;
+    std::string module_cache_dir = "";
+    bool no_module_cache = false; // Convert the imported modules from source
+    size_t jobs = 1; // The number of threads the front end can use
     std::string target = "";
     Platform platform;
 
@@ -39,7 +43,40 @@ struct CompilerOptions {
 };
 
 
+// The memory used by the compiler at some point, the difference of two is
+// the memory used by a compiler phase
+struct MemoryUsage {
+    size_t allocated = 0; // Bytes allocated from the Allocator
+    size_t chunks = 0; // Chunks of the Allocator
+    size_t wasted = 0; // Bytes released by Vec regrowth and not reused
+    size_t peak_rss = 0; // Peak resident set size of the process in bytes
+};
+
+MemoryUsage get_memory_usage(Allocator &al);
+// The peak resident set size of the process in bytes, 0 if unknown
+size_t get_peak_rss();
+
 bool read_file(const std::string &filename, std::string &text);
+
+// A read-only memory mapping of a whole file. The pages are read by the OS
+// when they are first accessed, nothing is copied up front.
+class MappedFile
+{
+    const char *data = nullptr;
+    size_t size = 0;
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() { close(); }
+
+    // Maps the file `filename`, returns false if it cannot be mapped
+    bool open(const std::string &filename);
+    void close();
+    // The contents of the file, valid until close()
+    std::string_view view() const { return std::string_view(data, size); }
+};
+
 bool present(Vec<char*> &v, const char* name);
 int initialize();
 
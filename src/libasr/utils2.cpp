@@ -1,6 +1,13 @@
 #ifdef _WIN32
 #define NOMINMAX
 #include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 #endif
 
 #include <fstream>
@@ -28,6 +35,69 @@ bool read_file(const std::string &filename, std::string &text)
     return true;
 }
 
+bool MappedFile::open(const std::string &filename)
+{
+    close();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ,
+        nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size)) {
+        CloseHandle(file);
+        return false;
+    }
+    if (file_size.QuadPart == 0) {
+        // An empty file cannot be mapped
+        CloseHandle(file);
+        return true;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0,
+        nullptr);
+    CloseHandle(file);
+    if (!mapping) return false;
+    // The view keeps the mapping alive
+    void *p = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!p) return false;
+    data = (const char*)p;
+    size = file_size.QuadPart;
+#else
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+    if (st.st_size == 0) {
+        // An empty file cannot be mapped
+        ::close(fd);
+        return true;
+    }
+    // The mapping stays valid after the file is closed
+    void *p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) return false;
+    data = (const char*)p;
+    size = st.st_size;
+#endif
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (data) {
+#ifdef _WIN32
+        UnmapViewOfFile(data);
+#else
+        munmap((void*)data, size);
+#endif
+    }
+    data = nullptr;
+    size = 0;
+}
+
 bool present(Vec<char*> &v, const char* name) {
     for (auto &a : v) {
         if (std::string(a) == std::string(name)) {
@@ -58,6 +128,37 @@ Platform get_platform()
 #endif
 }
 
+size_t get_peak_rss()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) {
+        return 0;
+    }
+    return pmc.PeakWorkingSetSize;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#    ifdef __APPLE__
+    // In bytes on macOS
+    return usage.ru_maxrss;
+#    else
+    // In kilobytes on Linux and FreeBSD
+    return (size_t)usage.ru_maxrss * 1024;
+#    endif
+#endif
+}
+
+MemoryUsage get_memory_usage(Allocator &al)
+{
+    MemoryUsage m;
+    m.allocated = al.size_allocated();
+    m.chunks = al.num_chunks();
+    m.wasted = al.size_released();
+    m.peak_rss = get_peak_rss();
+    return m;
+}
+
 // Platform-specific initialization
 // On Windows, enable colors in terminal. On other systems, do nothing.
 // Return value: 0 on success, negative number on failure.
@@ -9,12 +9,13 @@
 #include <libasr/diagnostics.h>
 #include <libasr/string_utils.h>
 #include <libasr/utils.h>
+#include <libasr/source_manager.h>
 #include <lpython/parser/parser_exception.h>
 #include <lpython/python_serialization.h>
 
 namespace LFortran {
 
-Result<LPython::AST::Module_t*> parse(Allocator &al, const std::string &s,
+Result<LPython::AST::Module_t*> parse(Allocator &al, std::string_view s,
         diag::Diagnostics &diagnostics)
 {
     Parser p(al, diagnostics);
@@ -42,15 +43,16 @@ Result<LPython::AST::Module_t*> parse(Allocator &al, const std::string &s,
         p.result.p, p.result.size(), nullptr, 0);
 }
 
-void Parser::parse(const std::string &input)
+void Parser::parse(std::string_view input)
 {
-    inp = input;
-    if (inp.size() > 0) {
-        if (inp[inp.size()-1] != '\n') inp.append("\n");
+    if (input.size() > 0 && input.back() == '\n') {
+        // The input (such as a SourceManager buffer) is tokenized in place
+        m_tokenizer.set_string(input);
     } else {
+        inp = input;
         inp.append("\n");
+        m_tokenizer.set_string(inp);
     }
-    m_tokenizer.set_string(inp);
     if (yyparse(*this) == 0) {
         return;
     }
@@ -119,7 +121,11 @@ Result<LPython::AST::ast_t*> parse_python_file(Allocator &al,
         bool new_parser) {
     LPython::AST::ast_t* ast;
     if (new_parser) {
-        std::string input = read_file(infile);
+        std::string_view input;
+        if (!get_source_manager().get_file(infile, input)) {
+            std::cerr << "The file '" << infile << "' cannot be read." << std::endl;
+            return Error();
+        }
         Result<LPython::AST::Module_t*> res = parse(al, input, diagnostics);
         if (res.ok) {
             ast = (LPython::AST::ast_t*)res.result;
@@ -24,14 +24,15 @@ public:
         result.reserve(al, 32);
     }
 
-    void parse(const std::string &input);
+    // The `input` must be followed by '\0' (see Tokenizer::set_string())
+    void parse(std::string_view input);
     void handle_yyerror(const Location &loc, const std::string &msg);
 };
 
 
 // Parses Python code to AST
 Result<LPython::AST::Module_t*> parse(Allocator &al,
-    const std::string &s,
+    std::string_view s,
     diag::Diagnostics &diagnostics);
 
 Result<LPython::AST::ast_t*> parse_python_file(Allocator &al,
@@ -1,6 +1,8 @@
 #ifndef LPYTHON_SRC_PARSER_TOKENIZER_H
 #define LPYTHON_SRC_PARSER_TOKENIZER_H
 
+#include <string_view>
+
 #include <libasr/exception.h>
 #include <libasr/alloc.h>
 #include <lpython/parser/parser_stype.h>
@@ -33,7 +35,7 @@ public:
 public:
     // Set the string to tokenize. The caller must ensure `str` will stay valid
     // as long as `lex` is being called.
-    void set_string(const std::string &str);
+    void set_string(std::string_view str);
 
     // Get next token. Token ID is returned as function result, the semantic
     // value is put into `yylval`.
@@ -54,6 +54,11 @@ public:
     Result<std::unique_ptr<LLVMModule>> get_llvm3(ASR::TranslationUnit_t &asr,
         LCompilers::PassManager& lpm, diag::Diagnostics &diagnostics);
 
+    // The allocator of the ASR passes and the LLVM backend
+    Allocator &get_allocator() {
+        return al;
+    }
+
 private:
     Allocator al;
 #ifdef HAVE_LFORTRAN_LLVM
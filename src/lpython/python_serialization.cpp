@@ -8,6 +8,31 @@
 
 namespace LFortran::LPython {
 
+// Written in front of the compact binary AST, so that deserialize_ast() can
+// tell it apart from the text format
+const std::string ast_binary_magic = "LPAST\x01";
+
+class ASTSerializationVisitor :
+        public CompactBinaryWriter,
+        public AST::SerializationBaseVisitor<ASTSerializationVisitor>
+{
+public:
+    void write_bool(bool b) {
+        if (b) {
+            write_int8(1);
+        } else {
+            write_int8(0);
+        }
+    }
+};
+
+std::string serialize_ast(const AST::ast_t &ast) {
+    ASTSerializationVisitor v;
+    v.write_int8(ast.type);
+    v.visit_ast(ast);
+    return ast_binary_magic + v.get_str();
+}
+
 class ASTDeserializationVisitor :
 #ifdef WITH_LFORTRAN_BINARY_MODFILES
     public BinaryReader,
@@ -39,7 +64,43 @@ public:
     }
 };
 
+// Deserializes the compact binary AST. Each string of the string table is
+// copied into the Allocator once, all its occurrences share the copy.
+class ASTCompactDeserializationVisitor :
+    public CompactBinaryReader,
+    public AST::DeserializationBaseVisitor<ASTCompactDeserializationVisitor>
+{
+    std::vector<char*> cstrings;
+public:
+    ASTCompactDeserializationVisitor(Allocator &al, std::string_view s) :
+        CompactBinaryReader(s),
+        DeserializationBaseVisitor(al, true),
+        cstrings(n_strings(), nullptr) {}
+
+    bool read_bool() {
+        uint8_t b = read_int8();
+        return (b == 1);
+    }
+
+    char* read_cstring() {
+        size_t id = read_string_id();
+        if (!cstrings[id]) {
+            std::string_view s = get_string(id);
+            char *p = al.allocate<char>(s.size() + 1);
+            std::memcpy(p, s.data(), s.size());
+            p[s.size()] = '\0';
+            cstrings[id] = p;
+        }
+        return cstrings[id];
+    }
+};
+
 AST::ast_t* deserialize_ast(Allocator &al, const std::string &s) {
+    if (startswith(s, ast_binary_magic)) {
+        ASTCompactDeserializationVisitor v(al, std::string_view(s).substr(
+            ast_binary_magic.size()));
+        return v.deserialize_node();
+    }
     ASTDeserializationVisitor v(al, s);
     return v.deserialize_node();
 }
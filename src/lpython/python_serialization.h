@@ -6,6 +6,10 @@
 
 namespace LFortran::LPython {
 
+    // Serializes `ast` into the compact binary format (see
+    // CompactBinaryWriter)
+    std::string serialize_ast(const AST::ast_t &ast);
+    // Accepts both the compact binary format and the text format
     AST::ast_t* deserialize_ast(Allocator &al, const std::string &s);
 
 }
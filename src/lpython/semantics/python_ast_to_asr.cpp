@@ -1,6 +1,8 @@
 #include <fstream>
 #include <iostream>
 #include <map>
+#include <unordered_map>
+#include <set>
 #include <memory>
 #include <string>
 #include <cmath>
@@ -9,13 +11,24 @@
 #include <complex>
 #include <sstream>
 #include <iterator>
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <mutex>
+#include <random>
+#include <cstdio>
 
 #include <libasr/asr.h>
 #include <libasr/asr_utils.h>
 #include <libasr/asr_verify.h>
+#include <libasr/asr_eval.h>
 #include <libasr/config.h>
 #include <libasr/string_utils.h>
 #include <libasr/utils.h>
+#include <libasr/modfile.h>
+#include <libasr/serialization.h>
+#include <libasr/source_manager.h>
+#include <libasr/thread_alloc.h>
 #include <libasr/pass/global_stmts_program.h>
 
 #include <lpython/python_ast.h>
@@ -37,21 +50,17 @@ LFortran::Result<std::string> get_full_path(const std::string &filename,
         const std::string &runtime_library_dir, bool &ltypes, bool &numpy) {
     ltypes = false;
     numpy = false;
-    std::string input;
-    bool status = read_file(filename, input);
-    if (status) {
+    if (SourceManager::file_exists(filename)) {
         return filename;
     } else {
         std::string filename_intrinsic = runtime_library_dir + "/" + filename;
-        status = read_file(filename_intrinsic, input);
-        if (status) {
+        if (SourceManager::file_exists(filename_intrinsic)) {
             return filename_intrinsic;
         } else {
             // If this is `ltypes`, do a special lookup
             if (filename == "ltypes.py") {
                 filename_intrinsic = runtime_library_dir + "/ltypes/" + filename;
-                status = read_file(filename_intrinsic, input);
-                if (status) {
+                if (SourceManager::file_exists(filename_intrinsic)) {
                     ltypes = true;
                     return filename_intrinsic;
                 } else {
@@ -59,8 +68,7 @@ LFortran::Result<std::string> get_full_path(const std::string &filename,
                 }
             } else if (filename == "numpy.py") {
                 filename_intrinsic = runtime_library_dir + "/lpython_intrinsic_numpy.py";
-                status = read_file(filename_intrinsic, input);
-                if (status) {
+                if (SourceManager::file_exists(filename_intrinsic)) {
                     numpy = true;
                     return filename_intrinsic;
                 } else {
@@ -73,71 +81,343 @@ LFortran::Result<std::string> get_full_path(const std::string &filename,
     }
 }
 
-ASR::Module_t* load_module(Allocator &al, SymbolTable *symtab,
-                            const std::string &module_name,
-                            const Location &loc, bool intrinsic,
-                            std::vector<std::string> &rl_path,
-                            bool &ltypes, bool &numpy,
-                            const std::function<void (const std::string &, const Location &)> err) {
-    ltypes = false;
-    numpy = false;
-    LFORTRAN_ASSERT(symtab);
-    if (symtab->get_scope().find(module_name) != symtab->get_scope().end()) {
-        ASR::symbol_t *m = symtab->get_symbol(module_name);
-        if (ASR::is_a<ASR::Module_t>(*m)) {
-            return ASR::down_cast<ASR::Module_t>(m);
-        } else {
-            err("The symbol '" + module_name + "' is not a module", loc);
+bool is_runtime_module(const std::string &infile,
+        const std::string &runtime_library_dir) {
+    return startswith(infile, runtime_library_dir + "/");
+}
+
+// The ASR of a runtime module `<name>.py` is cached in `<name>.mod` next to
+// it. The ASR of a user module is cached in the `module_cache_dir` (if set),
+// keyed by its name and path. Returns an empty string if there is no cache.
+std::string module_cache_filename(const std::string &module_name,
+        const std::string &infile, const std::string &runtime_library_dir,
+        const CompilerOptions &compiler_options) {
+    LFORTRAN_ASSERT(endswith(infile, ".py"))
+    if (is_runtime_module(infile, runtime_library_dir)) {
+        return infile.substr(0, infile.size()-3) + ".mod";
+    }
+    if (compiler_options.module_cache_dir.empty()) return "";
+    return compiler_options.module_cache_dir + "/" + module_name + "-"
+        + source_hash(infile) + ".mod";
+}
+
+// The hash under which the module source `input` is cached. The runtime
+// modules are precompiled by the build, for user modules the hash also
+// covers the compiler options that the cached ASR depends on.
+std::string module_source_hash(const std::string &infile,
+        std::string_view input, const std::string &runtime_library_dir,
+        const CompilerOptions &compiler_options) {
+    if (is_runtime_module(infile, runtime_library_dir)) {
+        return source_hash(input);
+    }
+    std::string options = "new_parser=" + std::to_string(compiler_options.new_parser)
+        + ";platform=" + std::to_string((int)compiler_options.platform) + ";";
+    return source_hash(options + source_hash(input));
+}
+
+// Loads the cached ASR of the module `infile` into `dependencies`. Returns
+// nullptr if there is no cache (or `no_module_cache` is set) or if it was
+// saved by a different compiler version or from a different source of the
+// module or of any of the modules it depends on. If `lazy_bodies` is not
+// null, the function bodies are left in it (see load_modfile()).
+ASR::TranslationUnit_t* load_module_cache(Allocator &al, SymbolTable &symtab,
+        const std::string &module_name, const std::string &infile,
+        const std::string &runtime_library_dir,
+        const CompilerOptions &compiler_options,
+        std::vector<ModfileDependency> &dependencies,
+        std::vector<ASRImageBody> *lazy_bodies=nullptr) {
+    if (compiler_options.no_module_cache) return nullptr;
+    std::string cache_file = module_cache_filename(module_name, infile,
+        runtime_library_dir, compiler_options);
+    if (cache_file.empty()) return nullptr;
+    // Mapped, not read: checking the header only touches its first pages
+    // and the ASR image is copied straight from the mapping
+    MappedFile modfile;
+    std::string hash;
+    std::string_view input;
+    if (!modfile.open(cache_file)) return nullptr;
+    if (!get_source_manager().get_file(infile, input)) return nullptr;
+    if (!read_modfile_header(modfile.view(), hash, dependencies)) return nullptr;
+    if (hash != module_source_hash(infile, input, runtime_library_dir,
+            compiler_options)) return nullptr;
+    for (auto &dep : dependencies) {
+        std::string_view dep_input;
+        if (!get_source_manager().get_file(dep.path, dep_input)) return nullptr;
+        if (dep.source_hash != module_source_hash(dep.path, dep_input,
+                runtime_library_dir, compiler_options)) return nullptr;
+    }
+    try {
+        return load_modfile(al, modfile.view(), false, symtab, lazy_bodies);
+    } catch (const LFortranException &) {
+        // A corrupted cache is ignored, the module is compiled from source
+        return nullptr;
+    }
+}
+
+// Collects the module sources that the module `m` (compiled into `tu`)
+// depends on, the dependencies of each imported module first. Returns false
+// if they are not all known, in which case `m` must not be cached.
+bool module_cache_dependencies(const ASR::TranslationUnit_t &tu,
+        const ASR::Module_t *m, std::vector<std::string> &rl_path,
+        const CompilerOptions &compiler_options,
+        std::vector<ModfileDependency> &dependencies) {
+    std::set<std::string> paths;
+    auto add_dependency = [&](const ModfileDependency &dep) {
+        if (paths.insert(dep.path).second) dependencies.push_back(dep);
+    };
+    for (auto &item : tu.m_global_scope->get_scope()) {
+        if (item.second == (ASR::symbol_t*)m) continue;
+        if (!ASR::is_a<ASR::Module_t>(*item.second)) continue;
+        ModfileDependency dep;
+        dep.module_name = item.first;
+        bool ltypes, numpy;
+        for (auto &path: rl_path) {
+            Result<std::string> rinfile = get_full_path(
+                dep.module_name + ".py", path, ltypes, numpy);
+            if (rinfile.ok) {
+                dep.path = rinfile.result;
+                break;
+            }
         }
+        std::string_view input;
+        if (!get_source_manager().get_file(dep.path, input)) return false;
+        dep.source_hash = module_source_hash(dep.path, input, rl_path[0],
+            compiler_options);
+        if (!is_runtime_module(dep.path, rl_path[0])) {
+            // A user module was cached when it was loaded, its cache
+            // records the modules it depends on in turn
+            MappedFile modfile;
+            std::string hash;
+            std::vector<ModfileDependency> dep_dependencies;
+            if (!modfile.open(module_cache_filename(dep.module_name, dep.path,
+                    rl_path[0], compiler_options))) return false;
+            if (!read_modfile_header(modfile.view(), hash, dep_dependencies)) return false;
+            if (hash != dep.source_hash) return false;
+            for (auto &d : dep_dependencies) add_dependency(d);
+        }
+        add_dependency(dep);
     }
-    LFORTRAN_ASSERT(symtab->parent == nullptr);
+    return true;
+}
 
-    // Parse the module `module_name`.py to AST
+// Saves the ASR of the user module `m` (compiled into `tu` from `input`) into
+// the module cache. Failures are ignored, the cache is only an optimization.
+void save_user_module_cache(Allocator &al, const ASR::TranslationUnit_t &tu,
+        ASR::Module_t *m, const std::string &module_name,
+        const std::string &infile, std::string_view input,
+        std::vector<std::string> &rl_path,
+        const CompilerOptions &compiler_options) {
+    std::string cache_file = module_cache_filename(module_name, infile,
+        rl_path[0], compiler_options);
+    if (cache_file.empty() || is_runtime_module(infile, rl_path[0])) return;
+    std::vector<ModfileDependency> dependencies;
+    if (!module_cache_dependencies(tu, m, rl_path, compiler_options,
+            dependencies)) return;
+    // A modfile contains just the module, without the modules it imports
+    SymbolTable *global_scope = al.make_new<SymbolTable>(nullptr);
+    global_scope->add_symbol(module_name, (ASR::symbol_t*)m);
+    ASR::TranslationUnit_t *tu2 = ASR::down_cast2<ASR::TranslationUnit_t>(
+        ASR::make_TranslationUnit_t(al, tu.base.base.loc, global_scope,
+        nullptr, 0));
+    std::string modfile;
+    try {
+        modfile = save_modfile(*tu2, module_source_hash(infile, input,
+            rl_path[0], compiler_options), dependencies);
+    } catch (const LFortranException &) {
+        // The module refers to symbols outside of it (such as the specific
+        // procedures of an intrinsic generic, which are in the global scope)
+        return;
+    }
+    // Written to a unique temporary file first and renamed, so that other
+    // compiler processes (or threads) never read a partially written cache
+    std::string tmp_file = cache_file + "." + std::to_string(
+        std::random_device()()) + ".tmp";
+    {
+        std::ofstream out(tmp_file, std::ios::out | std::ios::binary);
+        out << modfile;
+        if (!out) {
+            out.close();
+            std::remove(tmp_file.c_str());
+            return;
+        }
+    }
+    if (std::rename(tmp_file.c_str(), cache_file.c_str()) != 0) {
+        std::remove(tmp_file.c_str());
+    }
+}
+
+Result<std::string> save_module_cache(const std::string &module_name,
+        const std::string &runtime_library_dir,
+        diag::Diagnostics &diagnostics, CompilerOptions &compiler_options) {
+    std::string infile = runtime_library_dir + "/" + module_name + ".py";
+    std::string_view input;
+    if (!get_source_manager().get_file(infile, input)) {
+        throw LFortranException("Cannot read the runtime module '"
+            + infile + "'");
+    }
+    std::string outfile = compiler_options.module_cache_dir.empty()
+        ? module_cache_filename(module_name, infile, runtime_library_dir,
+            compiler_options)
+        : compiler_options.module_cache_dir + "/" + module_name + ".mod";
+    // A cache saved by a previous build must not be used if this one fails
+    std::remove(outfile.c_str());
+    Allocator al(1024*1024);
+    Result<AST::ast_t*> r = parse_python_file(al, runtime_library_dir, infile,
+        diagnostics, compiler_options.new_parser);
+    if (!r.ok) {
+        return r.error;
+    }
+    // Imported modules are always converted fully and never get a `main`
+    CompilerOptions module_options = compiler_options;
+    module_options.disable_main = false;
+    module_options.symtab_only = false;
+    Result<ASR::TranslationUnit_t*> r2 = python_ast_to_asr(al, *r.result,
+        diagnostics, module_options, false, runtime_library_dir);
+    if (!r2.ok) {
+        return r2.error;
+    }
+    std::ofstream out(outfile, std::ios::out | std::ios::binary);
+    out << save_modfile(*r2.result, source_hash(input));
+    if (!out) {
+        throw LFortranException("Cannot write the module cache '"
+            + outfile + "'");
+    }
+    return outfile;
+}
+
+// A module loaded by prepare_module(), but not yet inserted into a symbol
+// table by insert_module()
+struct PreparedModule {
+    std::string infile, path_used;
+    ASR::TranslationUnit_t *tu = nullptr; // nullptr on error
+    bool from_cache = false;
+    bool parse_failed = false;
+    std::vector<ModfileDependency> dependencies; // If `from_cache`
+    // The function bodies of an intrinsic module, if `from_cache`
+    std::vector<ASRImageBody> lazy_bodies;
+    diag::Diagnostics diagnostics; // If not `from_cache`
+};
+
+// Finds the module `module_name`.py in `rl_path`. Returns false if it
+// was not found.
+bool find_module(const std::string &module_name,
+        std::vector<std::string> &rl_path, bool &ltypes, bool &numpy,
+        std::string &infile, std::string &path_used) {
     std::string infile0 = module_name + ".py";
-    bool found = false;
-    std::string path_used = "", infile;
     for (auto path: rl_path) {
         Result<std::string> rinfile = get_full_path(infile0, path, ltypes, numpy);
         if (rinfile.ok) {
-            found = true;
             infile = rinfile.result;
             path_used = path;
-            break;
+            return true;
         }
     }
-    if (!found) {
-        err("Could not find the module '" + infile0 + "'", loc);
-    }
-    if (ltypes) return nullptr;
-    if (numpy) return nullptr;
+    return false;
+}
+
+// Loads the module `m.infile` from the module cache, or parses and converts it
+// to ASR. No symbol table is modified (`symtab` is only read), so that
+// modules can be prepared concurrently, each with its own Allocator. The
+// function bodies of an `intrinsic` module are only lowered (or loaded from
+// the cache) once they are used (see materialize_functions()).
+void prepare_module(Allocator &al, SymbolTable &symtab,
+        const std::string &module_name, PreparedModule &m, bool intrinsic,
+        std::vector<std::string> &rl_path, CompilerOptions &compiler_options) {
+    // The ASR of the runtime modules is precompiled by the build (see
+    // save_module_cache()) and the ASR of the user modules is cached with
+    // `--module-cache-dir`, we use it if it is up to date
+    m.tu = load_module_cache(al, symtab, module_name, m.infile, rl_path[0],
+        compiler_options, m.dependencies,
+        intrinsic ? &m.lazy_bodies : nullptr);
+    m.from_cache = (m.tu != nullptr);
+    if (m.from_cache) return;
 
-    // TODO: diagnostic should be an argument to this function
-    diag::Diagnostics diagnostics;
-    Result<AST::ast_t*> r = parse_python_file(al, rl_path[0], infile,
-        diagnostics, false);
+    // Parse the module `module_name`.py to AST
+    // The module is parsed with the same parser as the main file, so that
+    // with `--new-parser` no external Python interpreter is ever started
+    Result<AST::ast_t*> r = parse_python_file(al, rl_path[0], m.infile,
+        m.diagnostics, compiler_options.new_parser);
     if (!r.ok) {
-        err("The file '" + infile + "' failed to parse", loc);
+        m.parse_failed = true;
+        return;
     }
     LFortran::LPython::AST::ast_t* ast = r.result;
 
     // Convert the module from AST to ASR
-    LFortran::LocationManager lm;
-    lm.in_filename = infile;
+    // Imported modules never get a `main`
+    CompilerOptions module_options = compiler_options;
+    module_options.disable_main = false;
+    module_options.symtab_only = intrinsic;
     Result<ASR::TranslationUnit_t*> r2 = python_ast_to_asr(al, *ast,
-        diagnostics, false, false, false, path_used);
-    std::string input;
-    read_file(infile, input);
-    CompilerOptions compiler_options;
-    std::cerr << diagnostics.render(input, lm, compiler_options);
-    if (!r2.ok) {
-        LFORTRAN_ASSERT(diagnostics.has_error())
-        return nullptr; // Error
+        m.diagnostics, module_options, false, m.path_used);
+    if (r2.ok) {
+        m.tu = r2.result;
+    }
+}
+
+ASR::Module_t* load_module(Allocator &al, SymbolTable *symtab,
+                            const std::string &module_name,
+                            const Location &loc, bool intrinsic,
+                            std::vector<std::string> &rl_path,
+                            bool &ltypes, bool &numpy,
+                            CompilerOptions &compiler_options,
+                            const std::function<void (const std::string &, const Location &)> err);
+
+void add_lazy_bodies(SymbolTable *symtab, std::vector<ASRImageBody> &bodies);
+
+// Inserts the prepared module `m` into `symtab`, loading the modules its
+// cached ASR depends on first
+ASR::Module_t* insert_module(Allocator &al, SymbolTable *symtab,
+                            const std::string &module_name,
+                            PreparedModule &m,
+                            const Location &loc, bool intrinsic,
+                            std::vector<std::string> &rl_path,
+                            CompilerOptions &compiler_options,
+                            const std::function<void (const std::string &, const Location &)> err) {
+    if (m.parse_failed) {
+        err("The file '" + m.infile + "' failed to parse", loc);
+    }
+    std::string_view input;
+    if (m.from_cache) {
+        // Load the modules it depends on and point its ExternalSymbols to
+        // them. The runtime modules it calls intrinsic functions from are
+        // its `m_dependencies`.
+        ASR::Module_t *mod = ASRUtils::extract_module(*m.tu);
+        for (auto &dep : m.dependencies) {
+            bool dep_ltypes, dep_numpy;
+            bool dep_intrinsic = false;
+            for (size_t i=0; i < mod->n_dependencies; i++) {
+                if (dep.module_name == mod->m_dependencies[i]) dep_intrinsic = true;
+            }
+            load_module(al, symtab, dep.module_name, loc, dep_intrinsic,
+                rl_path, dep_ltypes, dep_numpy, compiler_options, err);
+        }
+        for (size_t i=0; i < mod->n_dependencies; i++) {
+            bool dep_ltypes, dep_numpy;
+            load_module(al, symtab, mod->m_dependencies[i], loc, true,
+                rl_path, dep_ltypes, dep_numpy, compiler_options, err);
+        }
+        fix_external_symbols(*m.tu, *symtab);
+        mod->m_loaded_from_mod = true;
+    } else {
+        // TODO: diagnostic should be an argument to this function
+        LFortran::LocationManager lm;
+        lm.in_filename = m.infile;
+        get_source_manager().get_file(m.infile, input);
+        std::cerr << m.diagnostics.render(input, lm, compiler_options);
+        if (!m.tu) {
+            LFORTRAN_ASSERT(m.diagnostics.has_error())
+            return nullptr; // Error
+        }
     }
-    ASR::TranslationUnit_t* mod1 = r2.result;
 
     // insert into `symtab`
-    ASR::Module_t *mod2 = ASRUtils::extract_module(*mod1);
+    ASR::Module_t *mod2 = ASRUtils::extract_module(*m.tu);
     mod2->m_name = s2c(al, module_name);
+    if (!m.from_cache) {
+        save_user_module_cache(al, *m.tu, mod2, module_name, m.infile, input,
+            rl_path, compiler_options);
+    }
     symtab->add_symbol(module_name, (ASR::symbol_t*)mod2);
     mod2->m_symtab->parent = symtab;
     mod2->m_intrinsic = intrinsic;
@@ -172,11 +452,53 @@ ASR::Module_t* load_module(Allocator &al, SymbolTable *symtab,
             }
         }
     }
+    if (!m.lazy_bodies.empty()) {
+        if (intrinsic) {
+            add_lazy_bodies(mod2->m_symtab, m.lazy_bodies);
+        } else {
+            for (auto &b : m.lazy_bodies) load_asr_image_body(b);
+        }
+        m.lazy_bodies.clear();
+    }
 
     // and return it
     return mod2;
 }
 
+ASR::Module_t* load_module(Allocator &al, SymbolTable *symtab,
+                            const std::string &module_name,
+                            const Location &loc, bool intrinsic,
+                            std::vector<std::string> &rl_path,
+                            bool &ltypes, bool &numpy,
+                            CompilerOptions &compiler_options,
+                            const std::function<void (const std::string &, const Location &)> err) {
+    ltypes = false;
+    numpy = false;
+    LFORTRAN_ASSERT(symtab);
+    if (symtab->get_symbol(module_name) != nullptr) {
+        ASR::symbol_t *m = symtab->get_symbol(module_name);
+        if (ASR::is_a<ASR::Module_t>(*m)) {
+            return ASR::down_cast<ASR::Module_t>(m);
+        } else {
+            err("The symbol '" + module_name + "' is not a module", loc);
+        }
+    }
+    LFORTRAN_ASSERT(symtab->parent == nullptr);
+
+    PreparedModule m;
+    if (!find_module(module_name, rl_path, ltypes, numpy, m.infile,
+            m.path_used)) {
+        err("Could not find the module '" + module_name + ".py'", loc);
+    }
+    if (ltypes) return nullptr;
+    if (numpy) return nullptr;
+
+    prepare_module(al, *symtab, module_name, m, intrinsic, rl_path,
+        compiler_options);
+    return insert_module(al, symtab, module_name, m, loc, intrinsic, rl_path,
+        compiler_options, err);
+}
+
 ASR::symbol_t* import_from_module(Allocator &al, ASR::Module_t *m, SymbolTable *current_scope,
                 std::string mname, std::string cur_sym_name, std::string new_sym_name,
                 const Location &loc) {
@@ -186,7 +508,7 @@ ASR::symbol_t* import_from_module(Allocator &al, ASR::Module_t *m, SymbolTable *
         throw SemanticError("The symbol '" + cur_sym_name + "' not found in the module '" + mname + "'",
                 loc);
     }
-    if (current_scope->get_scope().find(cur_sym_name) != current_scope->get_scope().end()) {
+    if (current_scope->get_symbol(cur_sym_name) != nullptr) {
         throw SemanticError(cur_sym_name + " already defined", loc);
     }
     if (ASR::is_a<ASR::Subroutine_t>(*t)) {
@@ -261,6 +583,13 @@ ASR::symbol_t* import_from_module(Allocator &al, ASR::Module_t *m, SymbolTable *
 }
 
 
+// Thrown by a function body lowered in parallel (see
+// BodyVisitor::lower_functions_parallel()) that needs to change a symbol table
+// shared with the other functions. The function is then lowered sequentially.
+class SharedScopeChange
+{
+};
+
 template <class Derived>
 class CommonVisitor : public AST::BaseVisitor<Derived> {
 public:
@@ -270,6 +599,7 @@ public:
     ASR::asr_t *tmp;
     Allocator &al;
     SymbolTable *current_scope;
+    std::unordered_map<const char*, uint32_t> name_ids; // See name_id()
     // The current_module contains the current module that is being visited;
     // this is used to append to the module dependencies if needed
     ASR::Module_t *current_module = nullptr;
@@ -282,16 +612,33 @@ public:
     std::map<int, ASR::symbol_t*> &ast_overload;
     std::string parent_dir;
     Vec<ASR::stmt_t*> *current_body;
+    CompilerOptions &compiler_options;
+    // If set, only this symbol table and the ones nested in it can be changed
+    SymbolTable *task_scope = nullptr;
+    ASRUtils::GenericProcedureCache overload_cache;
 
     CommonVisitor(Allocator &al, SymbolTable *symbol_table,
             diag::Diagnostics &diagnostics, bool main_module,
-            std::map<int, ASR::symbol_t*> &ast_overload, std::string parent_dir)
+            std::map<int, ASR::symbol_t*> &ast_overload, std::string parent_dir,
+            CompilerOptions &compiler_options)
         : diag{diagnostics}, al{al}, current_scope{symbol_table}, main_module{main_module},
             ast_overload{ast_overload}, parent_dir{parent_dir},
-            current_body{nullptr} {
+            current_body{nullptr}, compiler_options{compiler_options} {
         current_module_dependencies.reserve(al, 4);
     }
 
+    // The interned ID of an identifier of the AST. The IDs are cached by the
+    // address of the identifier, which is the same each time a Name is
+    // visited, so that resolving it again neither hashes the string nor
+    // locks the StringInterner.
+    uint32_t name_id(const char *name) {
+        auto it = name_ids.find(name);
+        if (it != name_ids.end()) return it->second;
+        uint32_t id = get_string_interner().intern(name);
+        name_ids[name] = id;
+        return id;
+    }
+
     ASR::asr_t* resolve_variable(const Location &loc, const std::string &var_name) {
         SymbolTable *scope = current_scope;
         ASR::symbol_t *v = scope->resolve_symbol(var_name);
@@ -304,17 +651,30 @@ public:
         return ASR::make_Var_t(al, loc, v);
     }
 
+    // Throws SharedScopeChange if `symtab` must not be changed, see
+    // `task_scope`
+    void check_scope_writable(const SymbolTable *symtab) {
+        if (!task_scope) return;
+        for (const SymbolTable *s = symtab; s; s = s->parent) {
+            if (s == task_scope) return;
+        }
+        throw SharedScopeChange();
+    }
+
     ASR::symbol_t* resolve_intrinsic_function(const Location &loc, const std::string &remote_sym) {
         LFORTRAN_ASSERT(intrinsic_procedures.is_intrinsic(remote_sym))
         std::string module_name = intrinsic_procedures.get_module(remote_sym, loc);
 
         SymbolTable *tu_symtab = ASRUtils::get_tu_symtab(current_scope);
+        if (!tu_symtab->get_symbol(module_name)) {
+            check_scope_writable(tu_symtab);
+        }
         std::string rl_path = get_runtime_library_dir();
         std::vector<std::string> paths = {rl_path, parent_dir};
         bool ltypes, numpy;
         ASR::Module_t *m = load_module(al, tu_symtab, module_name,
                 loc, true, paths,
-                ltypes, numpy,
+                ltypes, numpy, compiler_options,
                 [&](const std::string &msg, const Location &loc) { throw SemanticError(msg, loc); }
                 );
         LFORTRAN_ASSERT(!ltypes)
@@ -566,6 +926,20 @@ public:
     }
 
 
+    // Returns true if `s` is defined in the module whose code is visited. The
+    // functions of a runtime module are lowered once the module is already
+    // marked intrinsic (see materialize_functions()), but the calls between
+    // them are not evaluated at compile time.
+    bool in_current_module(const ASR::symbol_t *s) {
+        ASR::Module_t *m = ASRUtils::get_sym_module0(s);
+        if (!m) return false;
+        for (const SymbolTable *symtab = current_scope; symtab;
+                symtab = symtab->parent) {
+            if (symtab == m->m_symtab) return true;
+        }
+        return false;
+    }
+
     // Function to create appropriate call based on symbol type. If it is external
     // generic symbol then it changes the name accordingly.
     ASR::asr_t* make_call_helper(Allocator &al, ASR::symbol_t* s, SymbolTable *current_scope,
@@ -577,7 +951,7 @@ public:
         if (ASR::is_a<ASR::GenericProcedure_t>(*s)) {
             s_generic = stemp;
             ASR::GenericProcedure_t *p = ASR::down_cast<ASR::GenericProcedure_t>(s);
-            int idx = ASRUtils::select_generic_procedure(args, *p, loc,
+            int idx = overload_cache.select(args, *p, loc,
                 [&](const std::string &msg, const Location &loc) { throw SemanticError(msg, loc); });
             s = p->m_procs[idx];
             std::string remote_sym = ASRUtils::symbol_name(s);
@@ -587,14 +961,15 @@ public:
             }
 
             SymbolTable *symtab = current_scope;
-            while (symtab->parent != nullptr && symtab->get_scope().find(local_sym) == symtab->get_scope().end()) {
+            while (symtab->parent != nullptr && symtab->get_symbol(local_sym) == nullptr) {
                 symtab = symtab->parent;
             }
-            if (symtab->get_scope().find(local_sym) == symtab->get_scope().end()) {
+            if (symtab->get_symbol(local_sym) == nullptr) {
                 LFORTRAN_ASSERT(ASR::is_a<ASR::ExternalSymbol_t>(*stemp));
                 std::string mod_name = ASR::down_cast<ASR::ExternalSymbol_t>(stemp)->m_module_name;
                 ASR::symbol_t *mt = symtab->get_symbol(mod_name);
                 ASR::Module_t *m = ASR::down_cast<ASR::Module_t>(mt);
+                check_scope_writable(symtab);
                 stemp = import_from_module(al, m, symtab, mod_name,
                                     remote_sym, local_sym, loc);
                 LFORTRAN_ASSERT(ASR::is_a<ASR::ExternalSymbol_t>(*stemp));
@@ -609,7 +984,8 @@ public:
             ASR::ttype_t *a_type = ASRUtils::expr_type(func->m_return_var);
             a_type = handle_return_type(a_type, loc, args, func);
             ASR::expr_t *value = nullptr;
-            if (ASRUtils::is_intrinsic_function2(func)) {
+            if (ASRUtils::is_intrinsic_function2(func)
+                    && !in_current_module(s)) {
                 value = intrinsic_procedures.comptime_eval(call_name, al, loc, args);
             }
             if (args.size() != func->n_args) {
@@ -855,7 +1231,7 @@ public:
             int rkind = ASRUtils::extract_kind_from_ttype_t(right_type);
             if( left_type->type != right_type->type || lkind != rkind ) {
                 throw SemanticError("Casting for mismatching pointer types not supported yet.",
-                                    right_type->base.loc);
+                                    right->base.loc);
             }
         }
         return cast_helper(left_type, right, is_assign);
@@ -1316,7 +1692,7 @@ public:
         ASR::ttype_t *type = ast_expr_to_asr_type(x.base.base.loc, *x.m_annotation);
         if( ASR::is_a<ASR::Derived_t>(*type) &&
             wrap_derived_type_in_pointer ) {
-            type = ASRUtils::TYPE(ASR::make_Pointer_t(al, type->base.loc, type));
+            type = ASRUtils::TYPE(ASR::make_Pointer_t(al, x.base.base.loc, type));
         }
 
         ASR::expr_t *value = nullptr;
@@ -1379,6 +1755,10 @@ public:
     }
 
     void visit_ClassDef(const AST::ClassDef_t& x) {
+        if (task_scope) {
+            // The new symbol table must be numbered in source order
+            throw SharedScopeChange();
+        }
         std::string x_m_name = x.m_name;
         if( current_scope->resolve_symbol(x_m_name) ) {
             return ;
@@ -1472,7 +1852,7 @@ public:
 
     void visit_Name(const AST::Name_t &x) {
         std::string name = x.m_id;
-        ASR::symbol_t *s = current_scope->resolve_symbol(name);
+        ASR::symbol_t *s = current_scope->resolve_symbol(name_id(x.m_id));
         if (s) {
             tmp = ASR::make_Var_t(al, x.base.base.loc, s);
         } else if (name == "i32" || name == "i64" || name == "f32" || name == "f64") {
@@ -2062,8 +2442,10 @@ public:
 
     SymbolTableVisitor(Allocator &al, SymbolTable *symbol_table,
         diag::Diagnostics &diagnostics, bool main_module,
-        std::map<int, ASR::symbol_t*> &ast_overload, std::string parent_dir)
-      : CommonVisitor(al, symbol_table, diagnostics, main_module, ast_overload, parent_dir), is_derived_type{false} {}
+        std::map<int, ASR::symbol_t*> &ast_overload, std::string parent_dir,
+        CompilerOptions &compiler_options)
+      : CommonVisitor(al, symbol_table, diagnostics, main_module, ast_overload,
+            parent_dir, compiler_options), is_derived_type{false} {}
 
 
     ASR::symbol_t* resolve_symbol(const Location &loc, const std::string &sub_name) {
@@ -2103,7 +2485,7 @@ public:
                                         0,
                                         false, false);
 
-            if (parent_scope->get_scope().find(mod_name) != parent_scope->get_scope().end()) {
+            if (parent_scope->get_symbol(mod_name) != nullptr) {
                 throw SemanticError("Module '" + mod_name + "' already defined", tmp1->loc);
             }
             parent_scope->add_symbol(mod_name, ASR::down_cast<ASR::symbol_t>(tmp1));
@@ -2198,7 +2580,7 @@ public:
             }
             sym_name = "__lpython_overloaded_" + overload_number + "__" + sym_name;
         }
-        if (parent_scope->get_scope().find(sym_name) != parent_scope->get_scope().end()) {
+        if (parent_scope->get_symbol(sym_name) != nullptr) {
             throw SemanticError("Subroutine already defined", tmp->loc);
         }
         ASR::accessType s_access = ASR::accessType::Public;
@@ -2217,7 +2599,7 @@ public:
                     ASR::storage_typeType::Default, type,
                     current_procedure_abi_type, ASR::Public, ASR::presenceType::Required,
                     false);
-                LFORTRAN_ASSERT(current_scope->get_scope().find(return_var_name) == current_scope->get_scope().end())
+                LFORTRAN_ASSERT(current_scope->get_symbol(return_var_name) == nullptr)
                 current_scope->add_symbol(return_var_name,
                         ASR::down_cast<ASR::symbol_t>(return_var));
                 ASR::asr_t *return_var_ref = ASR::make_Var_t(al, x.base.base.loc,
@@ -2293,6 +2675,7 @@ public:
             bool ltypes, numpy;
             t = (ASR::symbol_t*)(load_module(al, st,
                 msym, x.base.base.loc, false, paths, ltypes, numpy,
+                compiler_options,
                 [&](const std::string &msg, const Location &loc) { throw SemanticError(msg, loc); }
                 ));
             if (ltypes || numpy) {
@@ -2334,6 +2717,7 @@ public:
             bool ltypes, numpy;
             t = (ASR::symbol_t*)(load_module(al, st,
                 mod_sym, x.base.base.loc, false, paths, ltypes, numpy,
+                compiler_options,
                 [&](const std::string &msg, const Location &loc) { throw SemanticError(msg, loc); }
                 ));
             if (ltypes || numpy) {
@@ -2364,9 +2748,11 @@ public:
 
 Result<ASR::asr_t*> symbol_table_visitor(Allocator &al, const AST::Module_t &ast,
         diag::Diagnostics &diagnostics, bool main_module,
-        std::map<int, ASR::symbol_t*> &ast_overload, std::string parent_dir)
+        std::map<int, ASR::symbol_t*> &ast_overload, std::string parent_dir,
+        CompilerOptions &compiler_options, SymbolTable *global_scope)
 {
-    SymbolTableVisitor v(al, nullptr, diagnostics, main_module, ast_overload, parent_dir);
+    SymbolTableVisitor v(al, global_scope, diagnostics, main_module,
+        ast_overload, parent_dir, compiler_options);
     try {
         v.visit_Module(ast);
     } catch (const SemanticError &e) {
@@ -2386,10 +2772,16 @@ private:
 
 public:
     ASR::asr_t *asr;
+    // If set, the bodies of the top level functions are not lowered, their
+    // definitions are collected here instead
+    std::map<ASR::symbol_t*, const AST::FunctionDef_t*> *lazy_functions
+        = nullptr;
 
     BodyVisitor(Allocator &al, ASR::asr_t *unit, diag::Diagnostics &diagnostics,
-         bool main_module, std::map<int, ASR::symbol_t*> &ast_overload)
-         : CommonVisitor(al, nullptr, diagnostics, main_module, ast_overload, ""), asr{unit} {}
+         bool main_module, std::map<int, ASR::symbol_t*> &ast_overload,
+         CompilerOptions &compiler_options)
+         : CommonVisitor(al, nullptr, diagnostics, main_module, ast_overload, "",
+            compiler_options), asr{unit} {}
 
     // Transforms statements to a list of ASR statements
     // In addition, it also inserts the following nodes if needed:
@@ -2405,7 +2797,8 @@ public:
             this->visit_stmt(*m_body[i]);
             if (tmp != nullptr) {
                 ASR::stmt_t* tmp_stmt = ASRUtils::STMT(tmp);
-                body.push_back(al, tmp_stmt);
+                // Only `current_body` points to it, not a copy
+                body.push_back_unique(al, tmp_stmt);
             }
             // To avoid last statement to be entered twice once we exit this node
             tmp = nullptr;
@@ -2423,13 +2816,41 @@ public:
             LFORTRAN_ASSERT(current_scope != nullptr);
         }
 
+        std::vector<FunctionTask> tasks;
+        if (compiler_options.jobs > 1 && !lazy_functions) {
+            lower_functions_parallel(x, tasks);
+        }
+        size_t next_task = 0;
+
         Vec<ASR::asr_t*> items;
         items.reserve(al, 4);
         for (size_t i=0; i<x.n_body; i++) {
+            if (next_task < tasks.size() && tasks[next_task].def
+                    == (AST::FunctionDef_t*)x.m_body[i]) {
+                FunctionTask &task = tasks[next_task++];
+                if (task.done) {
+                    diag.diagnostics.insert(diag.diagnostics.end(),
+                        task.diagnostics.diagnostics.begin(),
+                        task.diagnostics.diagnostics.end());
+                    al.absorb(*task.al);
+                    task.ids.assign();
+                    continue;
+                }
+            }
+            if (lazy_functions
+                    && AST::is_a<AST::FunctionDef_t>(*x.m_body[i])) {
+                AST::FunctionDef_t *def = AST::down_cast<AST::FunctionDef_t>(
+                    x.m_body[i]);
+                ASR::symbol_t *t = function_symbol(*def);
+                if (t && set_deftype(t, ASR::deftypeType::Interface)) {
+                    (*lazy_functions)[t] = def;
+                    continue;
+                }
+            }
             tmp = nullptr;
             visit_stmt(*x.m_body[i]);
             if (tmp) {
-                items.push_back(al, tmp);
+                items.push_back_unique(al, tmp);
             }
         }
         // These global statements are added to the translation unit for now,
@@ -2440,6 +2861,156 @@ public:
         tmp = asr;
     }
 
+    // The body of a top level function lowered by lower_functions_parallel()
+    struct FunctionTask {
+        const AST::FunctionDef_t *def;
+        ASR::symbol_t *sym; // The Function or Subroutine
+        std::unique_ptr<Allocator> al;
+        DeferredSymbolTableIds ids;
+        diag::Diagnostics diagnostics;
+        bool done = false;
+        // An internal error, rethrown once all threads are done
+        std::exception_ptr exception;
+    };
+
+    // Returns the Function or Subroutine that the body of the top level
+    // function `x` is lowered into, or nullptr
+    ASR::symbol_t *function_symbol(const AST::FunctionDef_t &x) {
+        ASR::symbol_t *t = current_scope->get_symbol(x.m_name);
+        if (t && ASR::is_a<ASR::GenericProcedure_t>(*t)) {
+            auto it = ast_overload.find((int64_t)&x);
+            t = it != ast_overload.end() ? it->second : nullptr;
+        }
+        if (!t || !(ASR::is_a<ASR::Function_t>(*t)
+                || ASR::is_a<ASR::Subroutine_t>(*t))) {
+            return nullptr;
+        }
+        return t;
+    }
+
+    // Changes the Function or Subroutine `t` from an Implementation to
+    // `deftype` or back. Returns false if `t` is an Interface itself.
+    static bool set_deftype(ASR::symbol_t *t, ASR::deftypeType deftype) {
+        ASR::deftypeType &d = ASR::is_a<ASR::Function_t>(*t)
+            ? ASR::down_cast<ASR::Function_t>(t)->m_deftype
+            : ASR::down_cast<ASR::Subroutine_t>(t)->m_deftype;
+        if (deftype == ASR::deftypeType::Interface
+                && d != ASR::deftypeType::Implementation) return false;
+        d = deftype;
+        return true;
+    }
+
+    // Returns the Function or Subroutine that the body of the top level
+    // function `x` is lowered into, or nullptr if it cannot be lowered in
+    // parallel with the other functions
+    ASR::symbol_t *parallel_function(const AST::FunctionDef_t &x) {
+        ASR::symbol_t *t = function_symbol(x);
+        if (!t) return nullptr;
+        // Nested scopes are not supported
+        for (auto &item : ASRUtils::symbol_symtab(t)->get_scope()) {
+            if (ASRUtils::symbol_symtab(item.second)) return nullptr;
+        }
+        return t;
+    }
+
+    // Lowers the bodies of the top level functions of `x` on
+    // `compiler_options.jobs` threads. The bodies only change the symbol
+    // table of their function, so each one is lowered by its own BodyVisitor
+    // into its own allocator. A body that fails (an error, or a change to a
+    // shared symbol table, see SharedScopeChange) is rolled back and left to
+    // the sequential loop in visit_Module(), which also merges the allocators,
+    // the diagnostics and the symbol table IDs of the lowered bodies in source
+    // order.
+    void lower_functions_parallel(const AST::Module_t &x,
+            std::vector<FunctionTask> &tasks) {
+        for (size_t i=0; i<x.n_body; i++) {
+            if (!AST::is_a<AST::FunctionDef_t>(*x.m_body[i])) continue;
+            AST::FunctionDef_t *def = AST::down_cast<AST::FunctionDef_t>(
+                x.m_body[i]);
+            ASR::symbol_t *sym = parallel_function(*def);
+            if (!sym) continue;
+            FunctionTask task;
+            task.def = def;
+            task.sym = sym;
+            task.al = std::make_unique<Allocator>(64*1024);
+            tasks.push_back(std::move(task));
+        }
+        if (tasks.size() < 2) {
+            tasks.clear();
+            return;
+        }
+
+        // The largest bodies first, so that a long one does not start last
+        std::vector<size_t> order(tasks.size());
+        for (size_t i=0; i < order.size(); i++) order[i] = i;
+        auto span = [&](size_t i) {
+            const Location &loc = tasks[i].def->base.base.loc;
+            return loc.last - loc.first;
+        };
+        std::stable_sort(order.begin(), order.end(),
+            [&](size_t a, size_t b) { return span(a) > span(b); });
+
+        SymbolTable *module_scope = current_scope;
+        std::atomic<size_t> next{0};
+        auto worker = [&]() {
+            // The types are allocated from the allocators of the tasks, which
+            // are freed if a task fails, so they are not interned on any
+            // thread (including this one)
+            ASRUtils::TypeInterner::Scope no_types(nullptr);
+            for (size_t i = next++; i < order.size(); i = next++) {
+                FunctionTask &task = tasks[order[i]];
+                SymbolTable *symtab = ASRUtils::symbol_symtab(task.sym);
+                auto scope = symtab->get_scope();
+                std::map<std::string, ASR::symbol_t*> saved(scope.begin(),
+                    scope.end());
+                DeferredSymbolTableIds::Scope defer_ids(task.ids);
+                BodyVisitor b(*task.al, asr, task.diagnostics, main_module,
+                    ast_overload, compiler_options);
+                b.current_scope = module_scope;
+                b.task_scope = symtab;
+                try {
+                    if (ASR::is_a<ASR::Function_t>(*task.sym)) {
+                        b.handle_fn(*task.def,
+                            *ASR::down_cast<ASR::Function_t>(task.sym));
+                    } else {
+                        b.handle_fn(*task.def,
+                            *ASR::down_cast<ASR::Subroutine_t>(task.sym));
+                    }
+                    task.done = true;
+                } catch (const SharedScopeChange &) {
+                } catch (const SemanticError &) {
+                } catch (const SemanticAbort &) {
+                } catch (...) {
+                    task.exception = std::current_exception();
+                }
+                if (!task.done) {
+                    // Lowered again sequentially, which also reports the
+                    // error (if any) in order
+                    std::vector<std::string> added;
+                    for (auto &item : symtab->get_scope()) {
+                        if (saved.find(item.first) == saved.end()) {
+                            added.push_back(item.first);
+                        }
+                    }
+                    for (auto &name : added) symtab->erase_symbol(name);
+                    for (auto &item : saved) {
+                        if (symtab->get_symbol(item.first) != item.second) {
+                            symtab->add_symbol(item.first, item.second);
+                        }
+                    }
+                }
+            }
+        };
+        std::vector<std::thread> threads;
+        size_t n_threads = std::min(compiler_options.jobs, tasks.size());
+        for (size_t i=1; i < n_threads; i++) threads.emplace_back(worker);
+        worker();
+        for (auto &t : threads) t.join();
+        for (auto &task : tasks) {
+            if (task.exception) std::rethrow_exception(task.exception);
+        }
+    }
+
     template <typename Procedure>
     void handle_fn(const AST::FunctionDef_t &x, Procedure &v) {
         current_scope = v.m_symtab;
@@ -2491,8 +3062,7 @@ public:
                 x.base.base.loc);
         }
 
-        if (current_scope->get_scope().find(var_name) !=
-                current_scope->get_scope().end()) {
+        if (current_scope->get_symbol(var_name) != nullptr) {
             if (current_scope->parent != nullptr) {
                 // Re-declaring a global scope variable is allowed,
                 // otherwise raise an error
@@ -2874,8 +3444,9 @@ public:
 
     void visit_Attribute(const AST::Attribute_t &x) {
         if (AST::is_a<AST::Name_t>(*x.m_value)) {
-            std::string value = AST::down_cast<AST::Name_t>(x.m_value)->m_id;
-            ASR::symbol_t *t = current_scope->resolve_symbol(value);
+            const char *value_id = AST::down_cast<AST::Name_t>(x.m_value)->m_id;
+            std::string value = value_id;
+            ASR::symbol_t *t = current_scope->resolve_symbol(name_id(value_id));
             if (!t) {
                 throw SemanticError("'" + value + "' is not defined in the scope",
                     x.base.base.loc);
@@ -3209,7 +3780,7 @@ public:
 
     void visit_Return(const AST::Return_t &x) {
         std::string return_var_name = "_lpython_return_variable";
-        if(current_scope->get_scope().find(return_var_name) == current_scope->get_scope().end()) {
+        if(current_scope->get_symbol(return_var_name) == nullptr) {
             if (x.m_value) {
                 throw SemanticError("Return type of function is not defined",
                                 x.base.base.loc);
@@ -3292,7 +3863,7 @@ public:
             if (AST::is_a<AST::Name_t>(*c->m_func)) {
                 AST::Name_t *n = AST::down_cast<AST::Name_t>(c->m_func);
                 call_name = n->m_id;
-                ASR::symbol_t* s = current_scope->resolve_symbol(call_name);
+                ASR::symbol_t* s = current_scope->resolve_symbol(name_id(n->m_id));
                 if( call_name == "c_p_pointer" && !s ) {
                     tmp = create_CPtrToPointer(*c);
                     return;
@@ -3389,7 +3960,8 @@ public:
                 tmp = ASR::make_Stop_t(al, x.base.base.loc, code);
                 return;
             }
-            ASR::symbol_t *s = current_scope->resolve_symbol(call_name);
+            ASR::symbol_t *s = current_scope->resolve_symbol(name_id(
+                AST::down_cast<AST::Name_t>(c->m_func)->m_id));
             if (!s) {
                 throw SemanticError("Function '" + call_name + "' is not declared",
                     x.base.base.loc);
@@ -3686,13 +4258,13 @@ public:
                 call_name = at->m_attr;
                 std::string call_name_store = "__" + mod_name + "_" + call_name;
                 ASR::symbol_t *st = nullptr;
-                if (current_scope->get_scope().find(call_name_store) != current_scope->get_scope().end()) {
+                if (current_scope->get_symbol(call_name_store) != nullptr) {
                     st = current_scope->get_symbol(call_name_store);
                 } else {
                     SymbolTable *symtab = current_scope;
                     while (symtab->parent != nullptr) symtab = symtab->parent;
-                    if (symtab->get_scope().find(mod_name) == symtab->get_scope().end()) {
-                        if (current_scope->get_scope().find(mod_name) != current_scope->get_scope().end()) {
+                    if (symtab->get_symbol(mod_name) == nullptr) {
+                        if (current_scope->get_symbol(mod_name) != nullptr) {
                             // this case when we have variable and attribute
                             st = current_scope->get_symbol(mod_name);
                             Vec<ASR::expr_t*> eles;
@@ -3725,7 +4297,9 @@ public:
                 x.base.base.loc);
         }
 
-        ASR::symbol_t *s = current_scope->resolve_symbol(call_name);
+        // Only a Name gets here
+        ASR::symbol_t *s = current_scope->resolve_symbol(name_id(
+            AST::down_cast<AST::Name_t>(x.m_func)->m_id));
 
         if (!s) {
             if (intrinsic_procedures.is_intrinsic(call_name)) {
@@ -3839,9 +4413,13 @@ Result<ASR::TranslationUnit_t*> body_visitor(Allocator &al,
         const AST::Module_t &ast,
         diag::Diagnostics &diagnostics,
         ASR::asr_t *unit, bool main_module,
-        std::map<int, ASR::symbol_t*> &ast_overload)
+        std::map<int, ASR::symbol_t*> &ast_overload,
+        CompilerOptions &compiler_options,
+        std::map<ASR::symbol_t*, const AST::FunctionDef_t*> *lazy_functions)
 {
-    BodyVisitor b(al, unit, diagnostics, main_module, ast_overload);
+    BodyVisitor b(al, unit, diagnostics, main_module, ast_overload,
+        compiler_options);
+    b.lazy_functions = lazy_functions;
     try {
         b.visit_Module(ast);
     } catch (const SemanticError &e) {
@@ -3856,6 +4434,137 @@ Result<ASR::TranslationUnit_t*> body_visitor(Allocator &al,
     return tu;
 }
 
+// The top level functions of a module converted with `symtab_only`, whose
+// bodies are lowered by materialize_functions() once they are used. For an
+// intrinsic module loaded from the cache, the bodies are already lowered and
+// only loaded once they are used.
+struct LazyModule {
+    std::map<int, ASR::symbol_t*> ast_overload;
+    CompilerOptions compiler_options;
+    std::map<ASR::symbol_t*, const AST::FunctionDef_t*> pending;
+    std::map<ASR::symbol_t*, ASRImageBody> cached;
+};
+
+// By the symbol table of the module. Modules are converted concurrently
+// by preload_modules(). Cleared at the start and the end of the main module,
+// so that a symbol table address reused by a later compilation is not found.
+std::mutex lazy_modules_mutex;
+std::map<SymbolTable*, std::unique_ptr<LazyModule>> lazy_modules;
+
+// Collects the symbols called or imported in a subtree
+class UsedSymbolsVisitor : public ASR::BaseWalkVisitor<UsedSymbolsVisitor>
+{
+public:
+    std::vector<ASR::symbol_t*> symbols;
+
+    void visit_ExternalSymbol(const ASR::ExternalSymbol_t &x) {
+        symbols.push_back(x.m_external);
+    }
+    void visit_FunctionCall(const ASR::FunctionCall_t &x) {
+        symbols.push_back(x.m_name);
+        if (x.m_original_name) symbols.push_back(x.m_original_name);
+        BaseWalkVisitor::visit_FunctionCall(x);
+    }
+    void visit_SubroutineCall(const ASR::SubroutineCall_t &x) {
+        symbols.push_back(x.m_name);
+        if (x.m_original_name) symbols.push_back(x.m_original_name);
+        BaseWalkVisitor::visit_SubroutineCall(x);
+    }
+    void visit_Var(const ASR::Var_t &x) {
+        symbols.push_back(x.m_v);
+    }
+};
+
+// The functions are Interfaces until their body is lowered or loaded
+void add_lazy_bodies(SymbolTable *symtab, std::vector<ASRImageBody> &bodies) {
+    auto lazy_module = std::make_unique<LazyModule>();
+    for (auto &b : bodies) {
+        BodyVisitor::set_deftype(b.function, ASR::deftypeType::Interface);
+        lazy_module->cached[b.function] = std::move(b);
+    }
+    std::lock_guard<std::mutex> lock(lazy_modules_mutex);
+    lazy_modules[symtab] = std::move(lazy_module);
+}
+
+// Returns the definition of `t` if its body is not lowered yet (or its
+// cached body in `body`, with `def` set to nullptr), and removes it from the
+// pending functions
+LazyModule *take_pending_function(ASR::symbol_t *t,
+        const AST::FunctionDef_t *&def, ASRImageBody &body) {
+    SymbolTable *parent = ASRUtils::symbol_parent_symtab(t);
+    std::lock_guard<std::mutex> lock(lazy_modules_mutex);
+    auto it = lazy_modules.find(parent);
+    if (it == lazy_modules.end()) return nullptr;
+    auto c = it->second->cached.find(t);
+    if (c != it->second->cached.end()) {
+        def = nullptr;
+        body = std::move(c->second);
+        it->second->cached.erase(c);
+        return it->second.get();
+    }
+    auto f = it->second->pending.find(t);
+    if (f == it->second->pending.end()) return nullptr;
+    def = f->second;
+    it->second->pending.erase(f);
+    return it->second.get();
+}
+
+// Lowers the bodies of the functions of the lazily converted modules
+// (see LazyModule) that `tu` uses, directly or through other functions. The
+// unused ones stay Interfaces without a body.
+Result<ASR::TranslationUnit_t*> materialize_functions(Allocator &al,
+        ASR::TranslationUnit_t &tu, diag::Diagnostics &diagnostics) {
+    UsedSymbolsVisitor v;
+    v.visit_TranslationUnit(tu);
+    std::set<ASR::symbol_t*> visited;
+    while (!v.symbols.empty()) {
+        ASR::symbol_t *t = ASRUtils::symbol_get_past_external(
+            v.symbols.back());
+        v.symbols.pop_back();
+        if (!visited.insert(t).second) continue;
+        if (ASR::is_a<ASR::GenericProcedure_t>(*t)) {
+            ASR::GenericProcedure_t *g
+                = ASR::down_cast<ASR::GenericProcedure_t>(t);
+            for (size_t i=0; i < g->n_procs; i++) {
+                v.symbols.push_back(g->m_procs[i]);
+            }
+            continue;
+        }
+        if (!ASR::is_a<ASR::Function_t>(*t)
+                && !ASR::is_a<ASR::Subroutine_t>(*t)) continue;
+        const AST::FunctionDef_t *def;
+        ASRImageBody body;
+        LazyModule *m = take_pending_function(t, def, body);
+        if (!m) continue;
+        if (!def) {
+            load_asr_image_body(body);
+            BodyVisitor::set_deftype(t, ASR::deftypeType::Implementation);
+            v.visit_symbol(*t);
+            continue;
+        }
+        BodyVisitor b(al, nullptr, diagnostics, false, m->ast_overload,
+            m->compiler_options);
+        b.current_scope = ASRUtils::symbol_parent_symtab(t);
+        BodyVisitor::set_deftype(t, ASR::deftypeType::Implementation);
+        try {
+            if (ASR::is_a<ASR::Function_t>(*t)) {
+                b.handle_fn(*def, *ASR::down_cast<ASR::Function_t>(t));
+            } else {
+                b.handle_fn(*def, *ASR::down_cast<ASR::Subroutine_t>(t));
+            }
+        } catch (const SemanticError &e) {
+            Error error;
+            diagnostics.diagnostics.push_back(e.d);
+            return error;
+        } catch (const SemanticAbort &) {
+            Error error;
+            return error;
+        }
+        v.visit_symbol(*t);
+    }
+    return &tu;
+}
+
 class PickleVisitor : public AST::PickleBaseVisitor<PickleVisitor>
 {
 public:
@@ -3896,17 +4605,120 @@ std::string get_parent_dir(const std::string &path) {
     return path.substr(0,idx);
 }
 
+// Loads the user modules imported at the top level of the main module `ast`
+// into `global_scope`, before the main module is visited. The modules are
+// prepared concurrently on `compiler_options.jobs` threads, each with its own
+// Allocator, and then inserted in the order of the imports, which is also
+// the order their symbol tables are numbered in, so that the ASR does not
+// depend on the scheduling. A module that fails is skipped, the visitor
+// loads it again and reports the error at the import.
+void preload_modules(Allocator &al, const AST::Module_t &ast,
+        SymbolTable &global_scope, const std::string &parent_dir,
+        CompilerOptions &compiler_options) {
+    std::vector<std::string> paths = {get_runtime_library_dir(), parent_dir};
+    std::vector<std::string> names;
+    std::vector<Location> locs;
+    std::vector<PreparedModule> modules;
+    auto add = [&](const std::string &module_name, const Location &loc) {
+        if (std::find(names.begin(), names.end(), module_name) != names.end()) {
+            return;
+        }
+        PreparedModule m;
+        bool ltypes, numpy;
+        if (!find_module(module_name, paths, ltypes, numpy, m.infile,
+                m.path_used)) return;
+        if (ltypes || numpy || is_runtime_module(m.infile, paths[0])) return;
+        names.push_back(module_name);
+        locs.push_back(loc);
+        modules.push_back(std::move(m));
+    };
+    for (size_t i=0; i < ast.n_body; i++) {
+        if (AST::is_a<AST::Import_t>(*ast.m_body[i])) {
+            AST::Import_t *x = AST::down_cast<AST::Import_t>(ast.m_body[i]);
+            for (size_t j=0; j < x->n_names; j++) {
+                add(x->m_names[j].m_name, x->base.base.loc);
+            }
+        } else if (AST::is_a<AST::ImportFrom_t>(*ast.m_body[i])) {
+            AST::ImportFrom_t *x = AST::down_cast<AST::ImportFrom_t>(
+                ast.m_body[i]);
+            if (x->m_module) add(x->m_module, x->base.base.loc);
+        }
+    }
+    if (modules.size() < 2) return;
+
+    ThreadAllocators allocators;
+    std::vector<DeferredSymbolTableIds> ids(modules.size());
+    std::vector<std::exception_ptr> exceptions(modules.size());
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        // Each module interns its types itself, on this thread as well
+        ASRUtils::TypeInterner::Scope no_types(nullptr);
+        for (size_t i = next++; i < modules.size(); i = next++) {
+            DeferredSymbolTableIds::Scope defer_ids(ids[i]);
+            try {
+                prepare_module(allocators.get(), global_scope, names[i],
+                    modules[i], false, paths, compiler_options);
+            } catch (...) {
+                exceptions[i] = std::current_exception();
+            }
+        }
+    };
+    std::vector<std::thread> threads;
+    size_t n_threads = std::min(compiler_options.jobs, modules.size());
+    for (size_t i=1; i < n_threads; i++) threads.emplace_back(worker);
+    worker();
+    for (auto &t : threads) t.join();
+    allocators.absorb_into(al);
+
+    for (size_t i=0; i < modules.size(); i++) {
+        if (exceptions[i]) std::rethrow_exception(exceptions[i]);
+        ids[i].assign();
+        PreparedModule &m = modules[i];
+        if (m.parse_failed || !m.tu) continue;
+        try {
+            insert_module(al, &global_scope, names[i], m, locs[i], false,
+                paths, compiler_options,
+                [&](const std::string &msg, const Location &loc) {
+                    throw SemanticError(msg, loc); });
+        } catch (const SemanticError &) {
+        }
+    }
+}
+
 Result<ASR::TranslationUnit_t*> python_ast_to_asr(Allocator &al,
-    AST::ast_t &ast, diag::Diagnostics &diagnostics, bool main_module,
-    bool disable_main, bool symtab_only, std::string file_path)
+    AST::ast_t &ast, diag::Diagnostics &diagnostics,
+    CompilerOptions &compiler_options, bool main_module,
+    std::string file_path)
 {
     std::map<int, ASR::symbol_t*> ast_overload;
     std::string parent_dir = get_parent_dir(file_path);
     AST::Module_t *ast_m = AST::down_cast2<AST::Module_t>(&ast);
 
+    // One for the whole translation unit, the modules it imports are
+    // converted by nested calls. On the worker threads of preload_modules()
+    // each module gets its own.
+    std::unique_ptr<ASRUtils::TypeInterner> types;
+    std::unique_ptr<ASRUtils::TypeInterner::Scope> types_scope;
+    if (!ASRUtils::TypeInterner::current()) {
+        types = std::make_unique<ASRUtils::TypeInterner>(al);
+        types_scope = std::make_unique<ASRUtils::TypeInterner::Scope>(*types);
+    }
+
+    if (main_module) {
+        // Left over if a previous compilation failed
+        std::lock_guard<std::mutex> lock(lazy_modules_mutex);
+        lazy_modules.clear();
+    }
+
     ASR::asr_t *unit;
+    SymbolTable *global_scope = nullptr;
+    if (main_module && compiler_options.jobs > 1) {
+        global_scope = al.make_new<SymbolTable>(nullptr);
+        preload_modules(al, *ast_m, *global_scope, parent_dir,
+            compiler_options);
+    }
     auto res = symbol_table_visitor(al, *ast_m, diagnostics, main_module,
-        ast_overload, parent_dir);
+        ast_overload, parent_dir, compiler_options, global_scope);
     if (res.ok) {
         unit = res.result;
     } else {
@@ -3915,21 +4727,53 @@ Result<ASR::TranslationUnit_t*> python_ast_to_asr(Allocator &al,
     ASR::TranslationUnit_t *tu = ASR::down_cast2<ASR::TranslationUnit_t>(unit);
     LFORTRAN_ASSERT(asr_verify(*tu));
 
-    if (!symtab_only) {
+    // An imported module converted with `symtab_only` has its module level
+    // statements lowered, but its functions only once they are used
+    bool lazy = compiler_options.symtab_only && !main_module;
+    if (!compiler_options.symtab_only || lazy) {
+        std::unique_ptr<LazyModule> lazy_module;
+        if (lazy) {
+            lazy_module = std::make_unique<LazyModule>();
+            lazy_module->compiler_options = compiler_options;
+            lazy_module->compiler_options.symtab_only = false;
+        }
         auto res2 = body_visitor(al, *ast_m, diagnostics, unit, main_module,
-            ast_overload);
+            ast_overload, compiler_options,
+            lazy ? &lazy_module->pending : nullptr);
         if (res2.ok) {
             tu = res2.result;
         } else {
             return res2.error;
         }
+        if (lazy) {
+            SymbolTable *symtab = ASR::down_cast<ASR::Module_t>(
+                tu->m_global_scope->get_symbol("__main__"))->m_symtab;
+            lazy_module->ast_overload = ast_overload;
+            std::lock_guard<std::mutex> lock(lazy_modules_mutex);
+            lazy_modules[symtab] = std::move(lazy_module);
+        }
+        auto res3 = materialize_functions(al, *tu, diagnostics);
+        if (!res3.ok) {
+            return res3.error;
+        }
+        if (main_module && compiler_options.fast) {
+            // After the imported modules are loaded and used functions
+            // materialized, so that calls into them can be evaluated
+            eval_pure_function_calls(al, *tu);
+        }
         LFORTRAN_ASSERT(asr_verify(*tu));
     }
 
+    if (main_module) {
+        // The functions not used by now never will be
+        std::lock_guard<std::mutex> lock(lazy_modules_mutex);
+        lazy_modules.clear();
+    }
+
     if (main_module) {
         // If it is a main module, turn it into a program
         // Note: we can modify this behavior for interactive mode later
-        if (disable_main) {
+        if (compiler_options.disable_main) {
             if (tu->n_items > 0) {
                 diagnostics.add(diag::Diagnostic(
                     "The script is invoked as the main module and it has code to execute,\n"
@@ -3,6 +3,7 @@
 
 #include <lpython/python_ast.h>
 #include <libasr/asr.h>
+#include <libasr/utils.h>
 
 namespace LFortran::LPython {
     
@@ -10,7 +11,17 @@ namespace LFortran::LPython {
     std::string pickle_tree_python(AST::ast_t &ast, bool colors=true);
     Result<ASR::TranslationUnit_t*> python_ast_to_asr(Allocator &al,
         LPython::AST::ast_t &ast, diag::Diagnostics &diagnostics,
-        bool main_module, bool disable_main, bool symtab_only, std::string file_path);
+        CompilerOptions &compiler_options, bool main_module,
+        std::string file_path);
+
+    // Compiles the runtime module `module_name`.py from `runtime_library_dir`
+    // and saves its ASR next to it (or into the `module_cache_dir` if set,
+    // e.g. the runtime directory of the build), so that load_module() can use
+    // it instead of parsing and analyzing the module again. Returns the cache
+    // filename.
+    Result<std::string> save_module_cache(const std::string &module_name,
+        const std::string &runtime_library_dir,
+        diag::Diagnostics &diagnostics, CompilerOptions &compiler_options);
 
 } // namespace LFortran
 
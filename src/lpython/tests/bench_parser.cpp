@@ -0,0 +1,209 @@
+// Tokenizer and parser throughput benchmark.
+//
+// Generates a synthetic Python source of a given size and shape, then
+// measures Tokenizer::lex() and Parser::parse() on it separately. Usage:
+//
+//     bench_parser [--shape all|expr|functions|strings|indent] [--size MB]
+//                  [--repeat N] [--json]
+//
+// With `--json` the results are printed as a JSON object, so that they can be
+// collected and compared over time.
+
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <lpython/parser/parser.h>
+#include <lpython/parser/parser.tab.hh>
+#include <lpython/python_ast.h>
+
+namespace {
+
+// Nested parenthesized expression, `depth` levels deep
+std::string gen_expr(size_t depth) {
+    if (depth == 0) return "x";
+    return "(" + gen_expr(depth-1) + " + " + std::to_string(depth)
+        + ") * y" + std::to_string(depth % 10);
+}
+
+// Appends code of the given `shape` to `out`, `i` distinguishes the
+// generated names
+void gen_block(std::string &out, const std::string &shape, size_t i) {
+    std::string n = std::to_string(i);
+    if (shape == "expr") {
+        out += "z" + n + " = " + gen_expr(64) + "\n";
+    } else if (shape == "functions") {
+        out += "def f" + n + "(a: i32, b: f64, c: list[i32]) -> f64:\n"
+            "    d: f64\n"
+            "    d = a * b + c[0] - f" + n + "(a-1, b/2.0, c)\n"
+            "    return d\n\n";
+    } else if (shape == "strings") {
+        out += "s" + n + ": str = \"" + std::string(1000, 'a' + i % 26)
+            + "\"\n";
+    } else if (shape == "indent") {
+        std::string ind;
+        for (size_t level=0; level < 30; level++) {
+            out += ind + "if x" + n + " > " + std::to_string(level) + ":\n";
+            ind += "    ";
+        }
+        out += ind + "x" + n + " = 0\n";
+    }
+}
+
+std::string generate(const std::string &shape, size_t size) {
+    static const std::vector<std::string> shapes
+        = {"expr", "functions", "strings", "indent"};
+    std::string out;
+    for (size_t i=0; out.size() < size; i++) {
+        gen_block(out, shape == "all" ? shapes[i % shapes.size()] : shape, i);
+    }
+    return out;
+}
+
+class NodeCounter : public LFortran::LPython::AST::BaseWalkVisitor<NodeCounter>
+{
+public:
+    size_t n = 0;
+    void visit_stmt(const LFortran::LPython::AST::stmt_t &x) {
+        n++;
+        BaseWalkVisitor::visit_stmt(x);
+    }
+    void visit_expr(const LFortran::LPython::AST::expr_t &x) {
+        n++;
+        BaseWalkVisitor::visit_expr(x);
+    }
+};
+
+struct Measurement {
+    double time = 0; // ms, best of all repeats
+    size_t count = 0; // tokens or AST nodes
+    size_t allocator_bytes = 0;
+    size_t allocator_chunks = 0;
+};
+
+// Times `run`, the `count` of its result is not timed
+template <typename F, typename C>
+Measurement measure(size_t repeat, F run, C count) {
+    Measurement m;
+    for (size_t r=0; r < repeat; r++) {
+        // The same initial size as the compiler uses
+        Allocator al(4*1024);
+        auto t1 = std::chrono::high_resolution_clock::now();
+        auto result = run(al);
+        auto t2 = std::chrono::high_resolution_clock::now();
+        double t = std::chrono::duration<double, std::milli>(t2 - t1).count();
+        if (r == 0 || t < m.time) m.time = t;
+        m.count = count(result);
+        m.allocator_bytes = al.size_reserved();
+        m.allocator_chunks = al.num_chunks();
+    }
+    return m;
+}
+
+std::string json(const std::string &name, const Measurement &m,
+        const std::string &unit, size_t input_size) {
+    double s = m.time / 1000;
+    std::stringstream out;
+    out << "    \"" << name << "\": {\"time_ms\": " << m.time
+        << ", \"" << unit << "\": " << m.count
+        << ", \"" << unit << "_per_sec\": " << m.count / s
+        << ", \"mb_per_sec\": " << input_size / (1024.*1024) / s
+        << ", \"allocator_bytes\": " << m.allocator_bytes
+        << ", \"allocator_chunks\": " << m.allocator_chunks << "}";
+    return out.str();
+}
+
+void print(const std::string &name, const Measurement &m,
+        const std::string &unit, size_t input_size) {
+    double s = m.time / 1000;
+    std::cout << name << ": " << m.time << " ms, "
+        << m.count << " " << unit << ", "
+        << m.count / s << " " << unit << "/s, "
+        << input_size / (1024.*1024) / s << " MB/s, allocator: "
+        << m.allocator_bytes << " bytes in "
+        << m.allocator_chunks << " chunks" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    std::string shape = "all";
+    double size_mb = 16;
+    size_t repeat = 5;
+    bool json_output = false;
+    for (int i=1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--shape" && i+1 < argc) {
+            shape = argv[++i];
+        } else if (arg == "--size" && i+1 < argc) {
+            size_mb = std::stod(argv[++i]);
+        } else if (arg == "--repeat" && i+1 < argc) {
+            repeat = std::stoul(argv[++i]);
+        } else if (arg == "--json") {
+            json_output = true;
+        } else {
+            std::cerr << "Usage: bench_parser [--shape all|expr|functions|"
+                "strings|indent] [--size MB] [--repeat N] [--json]"
+                << std::endl;
+            return 1;
+        }
+    }
+    if (shape != "all" && shape != "expr" && shape != "functions"
+            && shape != "strings" && shape != "indent") {
+        std::cerr << "Unknown shape '" << shape << "'" << std::endl;
+        return 1;
+    }
+    if (repeat == 0) repeat = 1;
+
+    std::string input = generate(shape, size_mb * 1024 * 1024);
+
+    Measurement lex = measure(repeat, [&](Allocator &al) {
+        LFortran::diag::Diagnostics diagnostics;
+        LFortran::Tokenizer t;
+        t.set_string(input);
+        size_t n = 0;
+        int token;
+        do {
+            LFortran::YYSTYPE y;
+            LFortran::Location l;
+            token = t.lex(al, y, l, diagnostics);
+            n++;
+        } while (token != yytokentype::END_OF_FILE);
+        return n;
+    }, [](size_t n) { return n; });
+
+    Measurement parse = measure(repeat, [&](Allocator &al) {
+        LFortran::diag::Diagnostics diagnostics;
+        LFortran::Result<LFortran::LPython::AST::Module_t*> r
+            = LFortran::parse(al, input, diagnostics);
+        if (!r.ok) {
+            throw LFortran::LFortranException("bench_parser: parsing failed");
+        }
+        return r.result;
+    }, [](LFortran::LPython::AST::Module_t *m) {
+        NodeCounter c;
+        c.visit_Module(*m);
+        return c.n;
+    });
+
+    if (json_output) {
+        std::cout << "{" << std::endl;
+        std::cout << "    \"shape\": \"" << shape << "\"," << std::endl;
+        std::cout << "    \"input_bytes\": " << input.size() << ","
+            << std::endl;
+        std::cout << "    \"repeat\": " << repeat << "," << std::endl;
+        std::cout << json("tokenizer", lex, "tokens", input.size()) << ","
+            << std::endl;
+        std::cout << json("parser", parse, "nodes", input.size())
+            << std::endl;
+        std::cout << "}" << std::endl;
+    } else {
+        std::cout << "Input: " << shape << ", " << input.size() << " bytes"
+            << std::endl;
+        print("Tokenizer::lex", lex, "tokens", input.size());
+        print("Parser::parse", parse, "nodes", input.size());
+    }
+    return 0;
+}
@@ -0,0 +1,180 @@
+// ASR walk visitor stress benchmark.
+//
+// Builds an ASR of a given shape and depth, then measures how fast the
+// iterative ASR::BaseIterativeWalkVisitor walks it. Usage:
+//
+//     bench_walk [--shape expr|if] [--depth N] [--repeat N] [--recursive]
+//                [--json]
+//
+// The `expr` shape is a chain of `depth` nested binary operations, `if` are
+// `depth` nested `if` statements. With `--recursive` the recursive
+// ASR::BaseWalkVisitor is measured as well, which overflows the stack for
+// large depths. With `--json` the results are printed as a JSON object.
+
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include <libasr/asr.h>
+#include <libasr/asr_utils.h>
+
+namespace {
+
+namespace ASR = LFortran::ASR;
+
+// `(((x + 1) + 2) + ...)`, `depth` levels deep
+ASR::expr_t* gen_expr(Allocator &al, size_t depth) {
+    LFortran::Location loc;
+    loc.first = 1;
+    loc.last = 1;
+    ASR::ttype_t *i4 = LFortran::ASRUtils::TYPE(ASR::make_Integer_t(al, loc,
+        4, nullptr, 0));
+    ASR::expr_t *e = LFortran::ASRUtils::EXPR(ASR::make_IntegerConstant_t(al,
+        loc, 0, i4));
+    for (size_t i=1; i <= depth; i++) {
+        ASR::expr_t *c = LFortran::ASRUtils::EXPR(
+            ASR::make_IntegerConstant_t(al, loc, i, i4));
+        e = LFortran::ASRUtils::EXPR(ASR::make_IntegerBinOp_t(al, loc, e,
+            ASR::binopType::Add, c, i4, nullptr));
+    }
+    return e;
+}
+
+// `if (.true.) then; if (.true.) then; ...`, `depth` levels deep
+ASR::stmt_t* gen_if(Allocator &al, size_t depth) {
+    LFortran::Location loc;
+    loc.first = 1;
+    loc.last = 1;
+    ASR::ttype_t *l4 = LFortran::ASRUtils::TYPE(ASR::make_Logical_t(al, loc,
+        4, nullptr, 0));
+    ASR::stmt_t *s = LFortran::ASRUtils::STMT(ASR::make_Stop_t(al, loc,
+        nullptr));
+    for (size_t i=0; i < depth; i++) {
+        ASR::expr_t *test = LFortran::ASRUtils::EXPR(
+            ASR::make_LogicalConstant_t(al, loc, true, l4));
+        ASR::stmt_t **body = al.allocate<ASR::stmt_t*>(1);
+        body[0] = s;
+        s = LFortran::ASRUtils::STMT(ASR::make_If_t(al, loc, test, body, 1,
+            nullptr, 0));
+    }
+    return s;
+}
+
+template <class Base>
+class NodeCounter : public Base
+{
+public:
+    size_t n = 0;
+    void visit_stmt(const ASR::stmt_t &x) {
+        n++;
+        Base::visit_stmt(x);
+    }
+    void visit_expr(const ASR::expr_t &x) {
+        n++;
+        Base::visit_expr(x);
+    }
+};
+
+class IterativeCounter
+    : public NodeCounter<ASR::BaseIterativeWalkVisitor<IterativeCounter>> {};
+
+class RecursiveCounter
+    : public NodeCounter<ASR::BaseWalkVisitor<RecursiveCounter>> {};
+
+struct Measurement {
+    double time = 0; // ms, best of all repeats
+    size_t nodes = 0;
+};
+
+template <class Counter>
+Measurement measure(size_t repeat, ASR::expr_t *e, ASR::stmt_t *s) {
+    Measurement m;
+    // Reused, so that the iterative walker keeps its stack between repeats
+    Counter c;
+    for (size_t r=0; r < repeat; r++) {
+        c.n = 0;
+        auto t1 = std::chrono::high_resolution_clock::now();
+        if (e) c.visit_expr(*e);
+        if (s) c.visit_stmt(*s);
+        auto t2 = std::chrono::high_resolution_clock::now();
+        double t = std::chrono::duration<double, std::milli>(t2 - t1).count();
+        if (r == 0 || t < m.time) m.time = t;
+        m.nodes = c.n;
+    }
+    return m;
+}
+
+std::string json(const std::string &name, const Measurement &m) {
+    std::stringstream out;
+    out << "    \"" << name << "\": {\"time_ms\": " << m.time
+        << ", \"nodes\": " << m.nodes
+        << ", \"nodes_per_sec\": " << m.nodes / (m.time / 1000) << "}";
+    return out.str();
+}
+
+void print(const std::string &name, const Measurement &m) {
+    std::cout << name << ": " << m.time << " ms, " << m.nodes << " nodes, "
+        << m.nodes / (m.time / 1000) << " nodes/s" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    std::string shape = "expr";
+    size_t depth = 100000;
+    size_t repeat = 5;
+    bool recursive = false;
+    bool json_output = false;
+    for (int i=1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--shape" && i+1 < argc) {
+            shape = argv[++i];
+        } else if (arg == "--depth" && i+1 < argc) {
+            depth = std::stoul(argv[++i]);
+        } else if (arg == "--repeat" && i+1 < argc) {
+            repeat = std::stoul(argv[++i]);
+        } else if (arg == "--recursive") {
+            recursive = true;
+        } else if (arg == "--json") {
+            json_output = true;
+        } else {
+            std::cerr << "Usage: bench_walk [--shape expr|if] [--depth N] "
+                "[--repeat N] [--recursive] [--json]" << std::endl;
+            return 1;
+        }
+    }
+    if (shape != "expr" && shape != "if") {
+        std::cerr << "Unknown shape '" << shape << "'" << std::endl;
+        return 1;
+    }
+    if (repeat == 0) repeat = 1;
+
+    Allocator al(1024*1024);
+    ASR::expr_t *e = nullptr;
+    ASR::stmt_t *s = nullptr;
+    if (shape == "expr") {
+        e = gen_expr(al, depth);
+    } else {
+        s = gen_if(al, depth);
+    }
+
+    Measurement iterative = measure<IterativeCounter>(repeat, e, s);
+    Measurement rec;
+    if (recursive) rec = measure<RecursiveCounter>(repeat, e, s);
+
+    if (json_output) {
+        std::cout << "{" << std::endl;
+        std::cout << "    \"shape\": \"" << shape << "\"," << std::endl;
+        std::cout << "    \"depth\": " << depth << "," << std::endl;
+        std::cout << "    \"repeat\": " << repeat << "," << std::endl;
+        std::cout << json("iterative", iterative);
+        if (recursive) std::cout << "," << std::endl << json("recursive", rec);
+        std::cout << std::endl << "}" << std::endl;
+    } else {
+        std::cout << "Input: " << shape << ", depth " << depth << std::endl;
+        print("BaseIterativeWalkVisitor", iterative);
+        if (recursive) print("BaseWalkVisitor", rec);
+    }
+    return 0;
+}
@@ -0,0 +1,448 @@
+#include <tests/doctest.h>
+
+#include <string>
+#include <vector>
+
+#include <libasr/asr_utils.h>
+#include <libasr/asr_eval.h>
+#include <libasr/pass/pass_utils.h>
+
+namespace ASR = LFortran::ASR;
+using LFortran::ASRUtils::EXPR;
+using LFortran::ASRUtils::STMT;
+
+namespace {
+
+// Makes the ASR nodes of the tests, all located at the same line
+class ASRBuilder {
+public:
+    Allocator &al;
+    LFortran::Location loc;
+
+    ASRBuilder(Allocator &al, uint32_t line=1) : al{al} {
+        loc.first = line;
+        loc.last = line;
+    }
+
+    ASR::ttype_t* integer(int kind=4) {
+        return LFortran::ASRUtils::TYPE(ASR::make_Integer_t(al, loc, kind,
+            nullptr, 0));
+    }
+
+    // Adds the variable `name` to `symtab`
+    ASR::symbol_t* variable(LFortran::SymbolTable *symtab, const char *name,
+            ASR::intentType intent, ASR::ttype_t *type) {
+        ASR::symbol_t *v = ASR::down_cast<ASR::symbol_t>(
+            ASR::make_Variable_t(al, loc, symtab, LFortran::s2c(al, name),
+            intent, nullptr, nullptr, ASR::storage_typeType::Default, type,
+            ASR::abiType::Source, ASR::accessType::Public,
+            ASR::presenceType::Required, false));
+        symtab->add_symbol(name, v);
+        return v;
+    }
+
+    ASR::expr_t* var(ASR::symbol_t *v) {
+        return EXPR(ASR::make_Var_t(al, loc, v));
+    }
+
+    ASR::expr_t* constant(int64_t n, ASR::ttype_t *type) {
+        return EXPR(ASR::make_IntegerConstant_t(al, loc, n, type));
+    }
+
+    ASR::expr_t* binop(ASR::expr_t *left, ASR::binopType op,
+            ASR::expr_t *right, ASR::ttype_t *type) {
+        return EXPR(ASR::make_IntegerBinOp_t(al, loc, left, op, right, type,
+            nullptr));
+    }
+
+    ASR::stmt_t* assignment(ASR::expr_t *target, ASR::expr_t *value) {
+        return STMT(ASR::make_Assignment_t(al, loc, target, value, nullptr));
+    }
+
+    ASR::stmt_t* if_(ASR::expr_t *test, const std::vector<ASR::stmt_t*> &body,
+            const std::vector<ASR::stmt_t*> &orelse) {
+        return STMT(ASR::make_If_t(al, loc, test, copy(body), body.size(),
+            copy(orelse), orelse.size()));
+    }
+
+    ASR::stmt_t* print(const std::vector<ASR::expr_t*> &values) {
+        return STMT(ASR::make_Print_t(al, loc, nullptr, copy(values),
+            values.size(), nullptr, nullptr));
+    }
+
+    ASR::stmt_t* stop() {
+        return STMT(ASR::make_Stop_t(al, loc, nullptr));
+    }
+
+    ASR::Function_t* function(const char *name, LFortran::SymbolTable *symtab,
+            const std::vector<ASR::expr_t*> &args,
+            const std::vector<ASR::stmt_t*> &body, ASR::expr_t *return_var) {
+        return ASR::down_cast2<ASR::Function_t>(ASR::make_Function_t(al, loc,
+            symtab, LFortran::s2c(al, name), copy(args), args.size(),
+            copy(body), body.size(), return_var, ASR::abiType::Source,
+            ASR::accessType::Public, ASR::deftypeType::Implementation,
+            nullptr));
+    }
+
+    // Adds the program `name` to `global`, if any
+    ASR::Program_t* program(LFortran::SymbolTable *global, const char *name,
+            const std::vector<ASR::stmt_t*> &body) {
+        ASR::symbol_t *p = ASR::down_cast<ASR::symbol_t>(ASR::make_Program_t(
+            al, loc, al.make_new<LFortran::SymbolTable>(global),
+            LFortran::s2c(al, name), nullptr, 0, copy(body), body.size()));
+        if (global) global->add_symbol(name, p);
+        return ASR::down_cast<ASR::Program_t>(p);
+    }
+
+    ASR::TranslationUnit_t* unit(LFortran::SymbolTable *global) {
+        return ASR::down_cast2<ASR::TranslationUnit_t>(
+            ASR::make_TranslationUnit_t(al, loc, global, nullptr, 0));
+    }
+
+    // Copies `v` into the Allocator
+    template <typename T>
+    T** copy(const std::vector<T*> &v) {
+        T **p = al.allocate<T*>(v.size());
+        for (size_t i=0; i < v.size(); i++) p[i] = v[i];
+        return p;
+    }
+};
+
+// `function <name>(x) result(x) ... x = x + <c>`, located at `line`
+ASR::Function_t* make_test_function(Allocator &al, const char *name,
+        int64_t c, uint32_t line) {
+    ASRBuilder b(al, line);
+    LFortran::SymbolTable *symtab = al.make_new<LFortran::SymbolTable>(nullptr);
+    ASR::ttype_t *i4 = b.integer();
+    ASR::expr_t *x = b.var(b.variable(symtab, "x", ASR::intentType::InOut, i4));
+    return b.function(name, symtab, {x},
+        {b.assignment(x, b.binop(x, ASR::binopType::Add, b.constant(c, i4),
+        i4))}, x);
+}
+
+// `function <name>(a, b) result(r) ... r = a <op> b`, of integers of `kind`
+ASR::Function_t* make_binop_function(Allocator &al, const char *name,
+        ASR::binopType op, int kind) {
+    ASRBuilder b(al);
+    LFortran::SymbolTable *symtab = al.make_new<LFortran::SymbolTable>(nullptr);
+    ASR::ttype_t *type = b.integer(kind);
+    ASR::expr_t *x = b.var(b.variable(symtab, "a", ASR::intentType::In, type));
+    ASR::expr_t *y = b.var(b.variable(symtab, "b", ASR::intentType::In, type));
+    ASR::expr_t *r = b.var(b.variable(symtab, "r",
+        ASR::intentType::ReturnVar, type));
+    return b.function(name, symtab, {x, y},
+        {b.assignment(r, b.binop(x, op, y, type))}, r);
+}
+
+// Returns the value that `eval_pure_function_calls` gives to `f(a, b)`:
+// its string, or "-" if the call is left to run time
+std::string eval_call(Allocator &al, ASR::Function_t *f, int64_t a,
+        int64_t b) {
+    ASRBuilder c(al);
+    LFortran::SymbolTable *global = al.make_new<LFortran::SymbolTable>(nullptr);
+    f->m_symtab->parent = global;
+    global->add_symbol(f->m_name, (ASR::symbol_t*)f);
+    ASR::ttype_t *type = LFortran::ASRUtils::expr_type(f->m_return_var);
+    ASR::call_arg_t *args = al.allocate<ASR::call_arg_t>(2);
+    args[0].loc = c.loc;
+    args[0].m_value = c.constant(a, type);
+    args[1].loc = c.loc;
+    args[1].m_value = c.constant(b, type);
+    ASR::expr_t *call = EXPR(ASR::make_FunctionCall_t(al, c.loc,
+        (ASR::symbol_t*)f, nullptr, args, 2, type, nullptr, nullptr));
+    c.program(global, "main", {c.print({call})});
+    LFortran::eval_pure_function_calls(al, *c.unit(global));
+    ASR::expr_t *value = ASR::down_cast<ASR::FunctionCall_t>(call)->m_value;
+    global->erase_symbol(f->m_name);
+    if (!value) return "-";
+    return std::to_string(
+        ASR::down_cast<ASR::IntegerConstant_t>(value)->m_n);
+}
+
+}
+
+TEST_CASE("Test LFortran::eval_pure_function_calls") {
+    Allocator al(4*1024);
+    ASR::Function_t *div = make_binop_function(al, "div",
+        ASR::binopType::Div, 4);
+    CHECK(eval_call(al, div, 7, 2) == "3");
+    CHECK(eval_call(al, div, 0, 5) == "0");
+    // The backends do not agree on the rounding of negative operands
+    CHECK(eval_call(al, div, -7, 2) == "-");
+    CHECK(eval_call(al, div, 7, -2) == "-");
+    CHECK(eval_call(al, div, 7, 0) == "-");
+
+    ASR::Function_t *pow4 = make_binop_function(al, "pow4",
+        ASR::binopType::Pow, 4);
+    CHECK(eval_call(al, pow4, 2, 10) == "1024");
+    CHECK(eval_call(al, pow4, -2, 3) == "-8");
+    CHECK(eval_call(al, pow4, -1, 3) == "-1");
+    CHECK(eval_call(al, pow4, -1, 1000000000) == "1");
+    CHECK(eval_call(al, pow4, 0, 0) == "1");
+    CHECK(eval_call(al, pow4, 0, 7) == "0");
+    CHECK(eval_call(al, pow4, 2, 24) == "16777216");
+    // Negative exponents and results that a float does not represent
+    // exactly are left to run time
+    CHECK(eval_call(al, pow4, 2, -1) == "-");
+    CHECK(eval_call(al, pow4, 3, 40) == "-");
+    CHECK(eval_call(al, pow4, 2, 25) == "-");
+
+    ASR::Function_t *pow8 = make_binop_function(al, "pow8",
+        ASR::binopType::Pow, 8);
+    CHECK(eval_call(al, pow8, 2, 25) == "33554432");
+    CHECK(eval_call(al, pow8, 3, 33) == "5559060566555523");
+    CHECK(eval_call(al, pow8, 3, 34) == "-");
+}
+
+namespace {
+
+// Counts the visited statements and puts a `stop` before each `print`
+class PrintVisitor : public LFortran::PassUtils::PassVisitor<PrintVisitor>
+{
+public:
+    size_t visited = 0;
+
+    PrintVisitor(Allocator &al) : PassVisitor(al, nullptr) {
+        pass_result.reserve(al, 2);
+    }
+
+    ASR::SubtreeKinds relevant_kinds() {
+        return ASR::kinds_of(ASR::stmtType::Print);
+    }
+
+    void visit_stmt(const ASR::stmt_t &x) {
+        visited++;
+        PassVisitor::visit_stmt(x);
+    }
+
+    void visit_Print(const ASR::Print_t &x) {
+        pass_result.push_back(al, STMT(ASR::make_Stop_t(al, x.base.base.loc,
+            nullptr)));
+        retain_original_stmt = true;
+    }
+};
+
+}
+
+TEST_CASE("Test LFortran::PassUtils::SubtreeKindsCache") {
+    using LFortran::PassUtils::SubtreeKindsCache;
+    Allocator al(1024);
+    ASRBuilder b(al);
+    ASR::stmt_t *stop = b.stop();
+    ASR::stmt_t *print = b.print({});
+    ASR::Program_t *p = b.program(nullptr, "p", {stop, print, stop});
+
+    // Without a SubtreeKindsCache every statement is visited
+    PrintVisitor v1(al);
+    v1.visit_Program(*p);
+    CHECK(v1.visited == 3);
+    CHECK(p->n_body == 4);
+
+    SubtreeKindsCache cache;
+    SubtreeKindsCache::Scope scope(cache);
+    // Only the `print` is visited
+    PrintVisitor v2(al);
+    v2.visit_Program(*p);
+    CHECK(v2.visited == 1);
+    CHECK(p->n_body == 5);
+    CHECK(p->m_body[3] == print);
+    // The kinds of the new `stop` are known
+    SubtreeKindsCache::Body &body = cache.get(&p->base.base, p->m_body,
+        p->n_body);
+    CHECK(body.stmts.size() == 5);
+    CHECK(body.stmts[2] == ASR::kinds_of(ASR::stmtType::Stop));
+    CHECK(body.kinds == (ASR::kinds_of(ASR::stmtType::Stop)
+        | ASR::kinds_of(ASR::stmtType::Print)));
+
+    // A body without any `print` is skipped
+    p->n_body = 3;
+    PrintVisitor v3(al);
+    v3.visit_Program(*p);
+    CHECK(v3.visited == 0);
+    CHECK(p->n_body == 3);
+}
+
+namespace {
+
+// Records the order in which the statements and expressions are visited
+template <class Base>
+class VisitOrder : public Base
+{
+public:
+    std::vector<const void*> order;
+    void visit_stmt(const ASR::stmt_t &x) {
+        order.push_back(&x);
+        Base::visit_stmt(x);
+    }
+    void visit_expr(const ASR::expr_t &x) {
+        order.push_back(&x);
+        Base::visit_expr(x);
+    }
+};
+
+class IterativeVisitOrder
+    : public VisitOrder<ASR::BaseIterativeWalkVisitor<IterativeVisitOrder>> {};
+
+class RecursiveVisitOrder
+    : public VisitOrder<ASR::BaseWalkVisitor<RecursiveVisitOrder>> {};
+
+}
+
+TEST_CASE("Test BaseIterativeWalkVisitor") {
+    Allocator al(1024);
+    ASRBuilder b(al);
+    LFortran::SymbolTable *symtab = al.make_new<LFortran::SymbolTable>(nullptr);
+    ASR::ttype_t *i4 = b.integer();
+    ASR::expr_t *v[5];
+    const char *names[5] = {"a", "b", "c", "d", "e"};
+    for (size_t i=0; i < 5; i++) {
+        v[i] = b.var(b.variable(symtab, names[i], ASR::intentType::Local, i4));
+    }
+
+    // if a + b:
+    //     c = d
+    // else:
+    //     e = 1
+    ASR::stmt_t *s = b.if_(b.binop(v[0], ASR::binopType::Add, v[1], i4),
+        {b.assignment(v[2], v[3])}, {b.assignment(v[4], b.constant(1, i4))});
+    IterativeVisitOrder iterative;
+    iterative.visit_stmt(*s);
+    RecursiveVisitOrder recursive;
+    recursive.visit_stmt(*s);
+    CHECK(iterative.order.size() == 10);
+    CHECK(iterative.order == recursive.order);
+
+    // Deeper than the recursive walk could go
+    size_t depth = 100000;
+    ASR::expr_t *e = v[0];
+    for (size_t i = 0; i < depth; i++) {
+        e = b.binop(e, ASR::binopType::Add, b.constant(i, i4), i4);
+    }
+    IterativeVisitOrder deep;
+    deep.visit_expr(*e);
+    CHECK(deep.order.size() == 2*depth + 1);
+    CHECK(deep.order[0] == e);
+    CHECK(deep.order[1] == ASR::down_cast<ASR::IntegerBinOp_t>(e)->m_left);
+    CHECK(deep.order.back() == ASR::down_cast<ASR::IntegerBinOp_t>(e)->m_right);
+}
+
+TEST_CASE("Test LFortran::ASRUtils::StructuralHasher") {
+    Allocator al(1024);
+    ASR::Function_t *f = make_test_function(al, "f", 1, 1);
+    ASR::Function_t *g = make_test_function(al, "g", 1, 5);
+    ASR::Function_t *h = make_test_function(al, "f", 2, 1);
+    ASR::expr_t *f_sum = ASR::down_cast<ASR::Assignment_t>(
+        f->m_body[0])->m_value;
+    ASR::expr_t *g_sum = ASR::down_cast<ASR::Assignment_t>(
+        g->m_body[0])->m_value;
+    ASR::expr_t *h_sum = ASR::down_cast<ASR::Assignment_t>(
+        h->m_body[0])->m_value;
+
+    LFortran::ASRUtils::StructuralHasher hasher;
+    // Equal trees at different locations have the same hash
+    CHECK(hasher.hash(*f_sum) == hasher.hash(*g_sum));
+    CHECK(hasher.hash(*f_sum) != hasher.hash(*h_sum));
+    CHECK(hasher.hash(*f->m_body[0]) == hasher.hash(*g->m_body[0]));
+    CHECK(hasher.hash(f->m_body, f->n_body)
+        == hasher.hash(g->m_body, g->n_body));
+    CHECK(hasher.hash(f->m_body, f->n_body)
+        != hasher.hash(h->m_body, h->n_body));
+    CHECK(hasher.hash(f->m_body, 0) != hasher.hash(f->m_body, 1));
+    // The names of the functions themselves do not matter
+    CHECK(hasher.hash(*f) == hasher.hash(*g));
+    CHECK(hasher.hash(*f) != hasher.hash(*h));
+
+    // The hashes of the expressions and statements are cached
+    CHECK(hasher.size() > 0);
+    uint64_t hash = hasher.hash(*f_sum);
+    ASR::down_cast<ASR::IntegerConstant_t>(ASR::down_cast<ASR::IntegerBinOp_t>(
+        f_sum)->m_right)->m_n = 2;
+    CHECK(hasher.hash(*f_sum) == hash);
+    hasher.clear();
+    CHECK(hasher.size() == 0);
+    CHECK(hasher.hash(*f_sum) == hasher.hash(*h_sum));
+
+    // The hashes do not depend on the hasher
+    LFortran::ASRUtils::StructuralHasher other;
+    CHECK(other.hash(*g_sum) != hasher.hash(*f_sum));
+    CHECK(other.hash(*f) == hasher.hash(*h));
+}
+
+TEST_CASE("Test LFortran::ASRUtils::count_nodes") {
+    Allocator al(1024);
+    ASRBuilder b(al);
+    LFortran::SymbolTable *global = al.make_new<LFortran::SymbolTable>(nullptr);
+    ASR::TranslationUnit_t *unit = b.unit(global);
+    CHECK(LFortran::ASRUtils::count_nodes(*unit) == 0);
+    ASR::Function_t *f = make_test_function(al, "f", 1, 1);
+    f->m_symtab->parent = global;
+    global->add_symbol("f", (ASR::symbol_t*)f);
+    // 2 symbols (f, x), 1 statement, 6 expressions (4 Vars, the sum and the
+    // constant) and 3 types (of x, the sum and the constant)
+    CHECK(LFortran::ASRUtils::count_nodes(*unit) == 12);
+}
+
+TEST_CASE("Test LFortran::ASRUtils::TypeInterner") {
+    using LFortran::ASRUtils::TYPE;
+    Allocator al(1024);
+    ASRBuilder b(al);
+    const LFortran::Location &loc = b.loc;
+    // Not interned without a TypeInterner
+    CHECK(TYPE(ASR::make_Integer_t(al, loc, 4, nullptr, 0))
+        != TYPE(ASR::make_Integer_t(al, loc, 4, nullptr, 0)));
+
+    LFortran::ASRUtils::TypeInterner types(al);
+    {
+        LFortran::ASRUtils::TypeInterner::Scope scope(types);
+        CHECK(LFortran::ASRUtils::TypeInterner::current() == &types);
+        ASR::ttype_t *i4 = TYPE(ASR::make_Integer_t(al, loc, 4, nullptr, 0));
+        size_t allocated = al.size_allocated();
+        CHECK(TYPE(ASR::make_Integer_t(al, loc, 4, nullptr, 0)) == i4);
+        // The duplicate was freed
+        CHECK(al.size_allocated() == allocated);
+        CHECK(TYPE(ASR::make_Integer_t(al, loc, 8, nullptr, 0)) != i4);
+        CHECK(TYPE(ASR::make_Real_t(al, loc, 4, nullptr, 0)) != i4);
+        ASR::ttype_t *c5 = TYPE(ASR::make_Character_t(al, loc, 1, 5, nullptr,
+            nullptr, 0));
+        CHECK(TYPE(ASR::make_Character_t(al, loc, 1, 5, nullptr, nullptr, 0))
+            == c5);
+        CHECK(TYPE(ASR::make_Character_t(al, loc, 1, 6, nullptr, nullptr, 0))
+            != c5);
+        CHECK(types.size() == 5);
+
+        // Arrays are not interned
+        ASR::dimension_t *dims = al.allocate<ASR::dimension_t>(1);
+        dims[0].loc = loc;
+        dims[0].m_start = nullptr;
+        dims[0].m_length = nullptr;
+        CHECK(TYPE(ASR::make_Integer_t(al, loc, 4, dims, 1))
+            != TYPE(ASR::make_Integer_t(al, loc, 4, dims, 1)));
+        CHECK(types.size() == 5);
+
+        // The nodes of other allocators are neither interned nor freed
+        Allocator other(1024);
+        ASR::ttype_t *other_i4 = TYPE(ASR::make_Integer_t(other, loc, 4,
+            nullptr, 0));
+        CHECK(other_i4 != i4);
+        CHECK(ASR::down_cast<ASR::Integer_t>(other_i4)->m_kind == 4);
+        CHECK(TYPE(ASR::make_Integer_t(other, loc, 2, nullptr, 0))
+            != TYPE(ASR::make_Integer_t(other, loc, 2, nullptr, 0)));
+        CHECK(types.size() == 5);
+        {
+            // Turned off, e.g. on a worker thread
+            LFortran::ASRUtils::TypeInterner::Scope no_types(nullptr);
+            CHECK(LFortran::ASRUtils::TypeInterner::current() == nullptr);
+            CHECK(TYPE(ASR::make_Integer_t(al, loc, 4, nullptr, 0)) != i4);
+        }
+        CHECK(LFortran::ASRUtils::TypeInterner::current() == &types);
+
+        std::string error;
+        CHECK(types.verify(error));
+        // Interned types must not be modified
+        ASR::down_cast<ASR::Integer_t>(i4)->n_dims = 1;
+        CHECK(!types.verify(error));
+        CHECK(error.find("modified") != std::string::npos);
+        ASR::down_cast<ASR::Integer_t>(i4)->n_dims = 0;
+    }
+    CHECK(LFortran::ASRUtils::TypeInterner::current() == nullptr);
+}
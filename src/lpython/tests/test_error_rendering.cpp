@@ -2,6 +2,9 @@
 
 #include <iostream>
 #include <sstream>
+#include <chrono>
+#include <thread>
+#include <vector>
 
 #include <libasr/diagnostics.h>
 
@@ -320,3 +323,80 @@ semantic error: Error with label, two spans
 )""");
     CHECK(out == ref);
 }
+
+TEST_CASE("LocationManager: newlines") {
+    // Lines of varying lengths, so that the \n are at all positions within
+    // the vector registers
+    std::string input;
+    for (size_t i=0; i < 300; i++) {
+        input += std::string(i % 70, 'x') + "\n";
+        if (i % 7 == 0) input += "\n\n";
+    }
+    input += "no newline at the end";
+    for (size_t n=0; n < 100; n++) {
+        std::string s = input.substr(n);
+        std::vector<uint32_t> ref, newlines;
+        for (uint32_t pos=0; pos < s.size(); pos++) {
+            if (s[pos] == '\n') ref.push_back(pos);
+        }
+        LocationManager::get_newlines(s, newlines);
+        CHECK(newlines == ref);
+    }
+
+    // The newlines are only computed when a position is converted
+    LocationManager lm;
+    lm.init_simple(input);
+    CHECK(lm.in_newlines.size() == 0);
+    uint32_t line, col;
+    lm.pos_to_linecol(0, line, col);
+    CHECK(line == 1);
+    CHECK(col == 1);
+    CHECK(lm.in_newlines.size() > 0);
+    lm.pos_to_linecol(input.size()-1, line, col);
+    CHECK(line == lm.in_newlines.size()+1);
+    CHECK(col == 21);
+}
+
+TEST_CASE("LocationManager: newlines from several threads") {
+    std::string input;
+    for (size_t i=0; i < 10000; i++) input += "x = 1\n";
+    LocationManager lm;
+    lm.init_simple(input);
+    // The first calls race to compute the newlines
+    std::vector<uint32_t> lines(8);
+    std::vector<std::thread> threads;
+    for (size_t i=0; i < lines.size(); i++) {
+        threads.emplace_back([&lm, &lines, i]() {
+            uint32_t col;
+            lm.pos_to_linecol(6*(1000*i + 3) + 2, lines[i], col);
+        });
+    }
+    for (auto &t : threads) t.join();
+    for (size_t i=0; i < lines.size(); i++) {
+        CHECK(lines[i] == 1000*i + 4);
+    }
+    CHECK(lm.in_newlines.size() == 10000);
+}
+
+// Run with `--no-skip`
+TEST_CASE("LocationManager: newlines benchmark" * doctest::skip()) {
+    std::string input;
+    while (input.size() < 64*1024*1024) {
+        input += "    x: i32 = f(a, b) + g(c)  # a typical line of code\n";
+    }
+    std::vector<uint32_t> ref, newlines;
+    auto t1 = std::chrono::high_resolution_clock::now();
+    for (uint32_t pos=0; pos < input.size(); pos++) {
+        if (input[pos] == '\n') ref.push_back(pos);
+    }
+    auto t2 = std::chrono::high_resolution_clock::now();
+    LocationManager::get_newlines(input, newlines);
+    auto t3 = std::chrono::high_resolution_clock::now();
+    CHECK(newlines == ref);
+    std::cout << "Newline index of " << input.size() / (1024*1024)
+        << " MiB: scalar "
+        << std::chrono::duration<double, std::milli>(t2 - t1).count()
+        << " ms, get_newlines "
+        << std::chrono::duration<double, std::milli>(t3 - t2).count()
+        << " ms" << std::endl;
+}
@@ -3,9 +3,18 @@
 #include <iostream>
 #include <sstream>
 #include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <map>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <lpython/bigint.h>
+#include <libasr/string_interner.h>
+#include <libasr/asr_scopes.h>
+#include <libasr/thread_alloc.h>
+#include <libasr/source_manager.h>
 
 using LFortran::TRY;
 using LFortran::Result;
@@ -295,3 +304,410 @@ TEST_CASE("Test LFortran::Allocator 2") {
     // Must manually call the destructor:
     v->~vector<int>();
 }
+
+TEST_CASE("Test LFortran::Allocator extend and reuse") {
+    Allocator al(1024);
+    // The last allocation grows in place
+    char *p = (char*)al.alloc(16);
+    CHECK(al.extend(p, 16, 64));
+    CHECK((char*)al.alloc(8) == p + 64);
+    CHECK(!al.extend(p, 64, 128));
+
+    // Released blocks are reused by size class
+    al.release(p, 64);
+    CHECK(al.size_released() == 64);
+    CHECK(al.alloc_reuse(128) != p);
+    CHECK(al.alloc_reuse(40) == p);
+    CHECK(al.size_released() == 0);
+    CHECK(al.alloc_reuse(40) != p);
+
+    // Releasing the last allocation frees it
+    char *r = (char*)al.alloc(32);
+    al.release(r, 32);
+    CHECK(al.alloc(32) == r);
+}
+
+TEST_CASE("Test LFortran::Allocator accounting") {
+    Allocator al(1024);
+    size_t size = al.size_allocated();
+    al.alloc(100);
+    CHECK(al.size_allocated() - size == 104);
+    // A new chunk
+    al.alloc(2000);
+    CHECK(al.num_chunks() == 2);
+    CHECK(al.size_allocated() - size == 2104);
+
+    Allocator al2(1024);
+    void *p = al2.alloc(16);
+    CHECK(al2.owns(p));
+    CHECK(!al.owns(p));
+    al.absorb(al2);
+    CHECK(al.owns(p));
+    CHECK(al.num_chunks() == 3);
+    CHECK(al.size_allocated() - size == 2120);
+}
+
+TEST_CASE("Test Vec growth") {
+    Allocator al(1024*1024);
+    LFortran::Vec<int64_t> a, b, c;
+    a.reserve(al, 2);
+    b.reserve(al, 2);
+    for (int64_t i=0; i < 1000; i++) {
+        a.push_back_unique(al, i);
+        b.push_back_unique(al, -i);
+    }
+    for (int64_t i=0; i < 1000; i++) {
+        CHECK(a[i] == i);
+        CHECK(b[i] == -i);
+    }
+    // `c` cannot grow in place, but reuses the arrays released by `a` and
+    // `b`, only the final one is allocated
+    c.reserve(al, 2);
+    al.alloc(8);
+    size_t size = al.size_current();
+    for (int64_t i=0; i < 1000; i++) c.push_back_unique(al, 2*i);
+    for (int64_t i=0; i < 1000; i++) CHECK(c[i] == 2*i);
+    CHECK(al.size_current() - size == 1024*sizeof(int64_t));
+}
+
+TEST_CASE("Test Vec growth with a copy") {
+    Allocator al(1024*1024);
+    LFortran::Vec<int64_t> a, b;
+    a.reserve(al, 4);
+    for (int64_t i=0; i < 4; i++) a.push_back(al, i);
+    // A copy by value, as the parser makes, and an array that keeps `a`
+    // from growing in place
+    b = a;
+    al.alloc(8);
+    for (int64_t i=4; i < 100; i++) a.push_back(al, i);
+    CHECK(a.p != b.p);
+    for (int64_t i=0; i < 100; i++) CHECK(a[i] == i);
+    // The old array is not released, the copy still reads its elements
+    int64_t *p = (int64_t*)al.alloc_reuse(4*sizeof(int64_t));
+    CHECK(p != b.p);
+    p[0] = -1;
+    CHECK(b.size() == 4);
+    for (int64_t i=0; i < 4; i++) CHECK(b[i] == i);
+}
+
+TEST_CASE("Test Vec growth from a foreign array") {
+    Allocator al(1024*1024), ast_al(1024);
+    int64_t *ast_array = (int64_t*)ast_al.alloc(4*sizeof(int64_t));
+    int64_t *array = (int64_t*)al.alloc(8*sizeof(int64_t));
+    al.alloc(8);
+    for (int64_t i=0; i < 4; i++) ast_array[i] = array[i] = i;
+    // Neither the array of another Allocator nor a part of an array of
+    // `al` is released when the Vec grows
+    LFortran::Vec<int64_t> a, b;
+    a.from_pointer_n(ast_array, 4);
+    b.from_pointer_n(array, 4);
+    a.push_back_unique(al, 4);
+    b.push_back_unique(al, 4);
+    CHECK(a.p != ast_array);
+    CHECK(b.p != array);
+    CHECK(al.size_released() == 0);
+    CHECK(ast_al.size_released() == 0);
+    // The arrays allocated by growing are owned and released again
+    for (int64_t i=5; i < 100; i++) {
+        a.push_back_unique(al, i);
+        b.push_back_unique(al, i);
+    }
+    CHECK(al.size_released() > 0);
+    for (int64_t i=0; i < 100; i++) {
+        CHECK(a[i] == i);
+        CHECK(b[i] == i);
+    }
+    for (int64_t i=0; i < 4; i++) {
+        CHECK(ast_array[i] == i);
+        CHECK(array[i] == i);
+    }
+}
+
+TEST_CASE("Test LFortran::SourceManager") {
+    LFortran::SourceManager sm;
+    std::string filename = "_test_source_manager.py";
+    // Large enough to be mapped if it was read-only
+    std::string text1(100*1024, 'a'), text2 = "b = 2\n";
+    {
+        std::ofstream out(filename, std::ios::binary);
+        out << text1;
+    }
+    std::string_view view1, view2;
+    CHECK(sm.get_file(filename, view1));
+    CHECK(view1.size() == text1.size() + 1);
+    CHECK(view1.back() == '\n');
+    CHECK(view1.data()[view1.size()] == '\0');
+
+    // A writable file is read, so a change on disk does not change the text
+    // returned before. Another size makes the change visible to get_file().
+    {
+        std::ofstream out(filename, std::ios::binary);
+        out << text2;
+    }
+    CHECK(view1.size() == text1.size() + 1);
+    CHECK(view1.substr(0, 3) == "aaa");
+    CHECK(sm.get_file(filename, view2));
+    CHECK(view2 == text2);
+    CHECK(sm.num_stale_files() == 1);
+    sm.release_stale_files();
+    CHECK(sm.num_stale_files() == 0);
+    CHECK(sm.get_file(filename, view1));
+    CHECK(view1.data() == view2.data());
+    std::remove(filename.c_str());
+    CHECK(!sm.file_exists(filename));
+}
+
+TEST_CASE("Test LFortran::StringInterner") {
+    LFortran::StringInterner interner;
+    CHECK(interner.find("abc") == LFortran::StringInterner::not_found);
+    uint32_t a = interner.intern("abc");
+    uint32_t b = interner.intern("abd");
+    CHECK(a != b);
+    CHECK(interner.intern(std::string("ab") + "c") == a);
+    CHECK(interner.find("abc") == a);
+    CHECK(interner.str(a) == "abc");
+    CHECK(std::string(interner.c_str(b)) == "abd");
+    CHECK(interner.intern_c_str("abc") == interner.c_str(a));
+    CHECK(interner.intern("") != a);
+    CHECK(interner.size() == 3);
+
+    // Interned strings do not move as more strings are interned
+    const char *p = interner.c_str(a);
+    for (size_t i=0; i < 100000; i++) {
+        interner.intern("x" + std::to_string(i));
+    }
+    CHECK(interner.c_str(a) == p);
+    CHECK(interner.str(interner.find("x99999")) == "x99999");
+    CHECK(interner.size() == 100003);
+}
+
+TEST_CASE("Test LFortran::SymbolTable lookup") {
+    Allocator al(1024);
+    LFortran::SymbolTable *parent = al.make_new<LFortran::SymbolTable>(nullptr);
+    LFortran::SymbolTable *child = al.make_new<LFortran::SymbolTable>(parent);
+    // The lookups only compare the pointers, the symbols are not used
+    LFortran::ASR::symbol_t *s1 = (LFortran::ASR::symbol_t*)al.alloc(8);
+    LFortran::ASR::symbol_t *s2 = (LFortran::ASR::symbol_t*)al.alloc(8);
+    parent->add_symbol("symtab_test_a", s1);
+    child->add_symbol("symtab_test_b", s2);
+    CHECK(child->get_symbol("symtab_test_b") == s2);
+    CHECK(child->get_symbol("symtab_test_a") == nullptr);
+    CHECK(child->resolve_symbol("symtab_test_a") == s1);
+    CHECK(parent->resolve_symbol("symtab_test_b") == nullptr);
+    CHECK(child->resolve_symbol("symtab_test_never_added") == nullptr);
+    uint32_t id = LFortran::get_string_interner().find("symtab_test_a");
+    CHECK(child->resolve_symbol(id) == s1);
+    parent->erase_symbol("symtab_test_a");
+    CHECK(child->resolve_symbol("symtab_test_a") == nullptr);
+    CHECK(parent->n_symbols() == 0);
+
+    // get_scope() is sorted by name and is not changed by adding symbols
+    parent->add_symbol("symtab_test_c", s1);
+    parent->add_symbol("symtab_test_a", s2);
+    parent->add_symbol("symtab_test_b", s1);
+    std::vector<std::string> names;
+    for (auto &a : parent->get_scope()) {
+        names.push_back(a.first);
+        parent->add_symbol(a.first + "_copy", a.second);
+    }
+    CHECK(names == std::vector<std::string>{"symtab_test_a",
+        "symtab_test_b", "symtab_test_c"});
+    CHECK(parent->n_symbols() == 6);
+    CHECK(parent->get_scope()[1].first == "symtab_test_a_copy");
+    CHECK(parent->get_scope()[1].second == s2);
+}
+
+TEST_CASE("Test LFortran::SymbolIndex") {
+    Allocator al(1024);
+    LFortran::SymbolIndex index;
+    std::map<uint32_t, LFortran::ASR::symbol_t*> ref;
+    CHECK(index.find(5) == nullptr);
+    // Pseudo random inserts and erases, checked against std::map
+    uint32_t x = 1;
+    for (size_t i=0; i < 20000; i++) {
+        x = x * 1103515245 + 12345;
+        uint32_t id = (x >> 8) % 2000;
+        if ((x >> 4) % 3 == 0) {
+            index.erase(id);
+            ref.erase(id);
+        } else {
+            LFortran::ASR::symbol_t *sym
+                = (LFortran::ASR::symbol_t*)al.alloc(8);
+            index.insert(id, "", sym);
+            ref[id] = sym;
+        }
+    }
+    CHECK(index.size() == ref.size());
+    for (uint32_t id=0; id < 2000; id++) {
+        auto it = ref.find(id);
+        CHECK(index.find(id) == (it == ref.end() ? nullptr : it->second));
+    }
+}
+
+TEST_CASE("Test LFortran::SymbolTable resolve_symbol") {
+    Allocator al(1024);
+    LFortran::SymbolTable *global = al.make_new<LFortran::SymbolTable>(nullptr);
+    LFortran::SymbolTable *s = global;
+    for (size_t i=0; i < 5; i++) {
+        s = al.make_new<LFortran::SymbolTable>(s);
+    }
+    LFortran::ASR::symbol_t *s1 = (LFortran::ASR::symbol_t*)al.alloc(8);
+    LFortran::ASR::symbol_t *s2 = (LFortran::ASR::symbol_t*)al.alloc(8);
+    global->add_symbol("resolve_test", s1);
+    CHECK(s->resolve_symbol("resolve_test") == s1);
+    // The nearest scope wins
+    s->parent->add_symbol("resolve_test", s2);
+    CHECK(s->resolve_symbol("resolve_test") == s2);
+    s->parent->erase_symbol("resolve_test");
+    CHECK(s->resolve_symbol("resolve_test") == s1);
+}
+
+TEST_CASE("SymbolTable lookup benchmark" * doctest::skip()) {
+    // Compares the lookup of all symbols of a module with thousands of
+    // symbols from a nested scope with std::map
+    size_t n = 10000;
+    Allocator al(1024*1024);
+    LFortran::SymbolTable *global = al.make_new<LFortran::SymbolTable>(nullptr);
+    LFortran::SymbolTable *module = al.make_new<LFortran::SymbolTable>(global);
+    LFortran::SymbolTable *function = al.make_new<LFortran::SymbolTable>(module);
+    std::vector<std::map<std::string, LFortran::ASR::symbol_t*>> maps(3);
+    std::vector<std::string> names;
+    for (size_t i=0; i < n; i++) {
+        names.push_back("module_symbol_" + std::to_string(i));
+        LFortran::ASR::symbol_t *sym = (LFortran::ASR::symbol_t*)al.alloc(8);
+        module->add_symbol(names.back(), sym);
+        maps[1][names.back()] = sym;
+    }
+    size_t repeat = 100;
+
+    auto t1 = std::chrono::high_resolution_clock::now();
+    size_t found = 0;
+    for (size_t r=0; r < repeat; r++) {
+        for (auto &name : names) {
+            // What SymbolTable::resolve_symbol() used to do
+            for (auto &m : maps) {
+                if (m.find(name) != m.end()) {
+                    found += (m[name] != nullptr);
+                    break;
+                }
+            }
+        }
+    }
+    auto t2 = std::chrono::high_resolution_clock::now();
+    for (size_t r=0; r < repeat; r++) {
+        for (auto &name : names) {
+            found += (function->resolve_symbol(name) != nullptr);
+        }
+    }
+    auto t3 = std::chrono::high_resolution_clock::now();
+    std::vector<uint32_t> ids;
+    for (auto &name : names) {
+        ids.push_back(LFortran::get_string_interner().find(name));
+    }
+    for (size_t r=0; r < repeat; r++) {
+        for (uint32_t id : ids) {
+            found += (function->resolve_symbol(id) != nullptr);
+        }
+    }
+    auto t4 = std::chrono::high_resolution_clock::now();
+    CHECK(found == 3*n*repeat);
+    std::cout << "std::map:             " << std::chrono::duration<double,
+        std::milli>(t2 - t1).count() << " ms" << std::endl;
+    std::cout << "resolve_symbol(name): " << std::chrono::duration<double,
+        std::milli>(t3 - t2).count() << " ms" << std::endl;
+    std::cout << "resolve_symbol(id):   " << std::chrono::duration<double,
+        std::milli>(t4 - t3).count() << " ms" << std::endl;
+}
+
+TEST_CASE("Test LFortran::Allocator absorb") {
+    Allocator al(32);
+    int *p;
+    {
+        Allocator al2(64);
+        al2.alloc(100);
+        p = al2.allocate<int>(4);
+        p[3] = 7;
+        CHECK(al2.num_chunks() == 2);
+        al.absorb(al2);
+        CHECK(al2.num_chunks() == 0);
+        CHECK(al2.size_reserved() == 0);
+    }
+    // The memory of `al2` is now owned by `al`
+    CHECK(p[3] == 7);
+    CHECK(al.num_chunks() == 3);
+    CHECK(al.size_reserved() == 40 + 72 + 144);
+}
+
+TEST_CASE("Test ThreadAllocators") {
+    ThreadAllocators allocators(64);
+    std::vector<int*> p(4);
+    std::vector<Allocator*> al(4);
+    std::vector<std::thread> threads;
+    for (size_t i=0; i < 4; i++) {
+        threads.emplace_back([&, i]() {
+            al[i] = &allocators.get();
+            CHECK(&allocators.get() == al[i]);
+            p[i] = al[i]->allocate<int>(100);
+            p[i][99] = i;
+        });
+    }
+    for (auto &t : threads) t.join();
+    for (size_t i=1; i < 4; i++) CHECK(al[i] != al[0]);
+
+    Allocator main_al(32);
+    allocators.absorb_into(main_al);
+    CHECK(main_al.num_chunks() == 1 + 4*2);
+    for (size_t i=0; i < 4; i++) {
+        CHECK(main_al.owns(p[i]));
+        CHECK(p[i][99] == (int)i);
+    }
+}
+
+TEST_CASE("Test LFortran::DeferredSymbolTableIds") {
+    Allocator al(1024);
+    std::vector<LFortran::DeferredSymbolTableIds> ids(4);
+    std::vector<std::vector<LFortran::SymbolTable*>> symtabs(4);
+    std::vector<std::thread> threads;
+    for (size_t i=0; i < 4; i++) {
+        threads.emplace_back([&, i]() {
+            LFortran::DeferredSymbolTableIds::Scope defer_ids(ids[i]);
+            for (size_t j=0; j < 10; j++) {
+                symtabs[i].push_back(al.make_new<LFortran::SymbolTable>(
+                    nullptr));
+            }
+        });
+        // `al` is not thread safe
+        threads.back().join();
+    }
+    // Not deferred
+    LFortran::SymbolTable *s = al.make_new<LFortran::SymbolTable>(nullptr);
+    for (size_t i=0; i < 4; i++) ids[i].assign();
+    // In the order of the assign() calls, the temporary IDs do not use up
+    // any final ones
+    unsigned int first = symtabs[0][0]->counter;
+    CHECK(first == s->counter + 1);
+    for (size_t i=0; i < 4; i++) {
+        for (size_t j=0; j < 10; j++) {
+            CHECK(symtabs[i][j]->counter == first + 10*i + j);
+        }
+    }
+
+    // Nested: assigned with the enclosing ones, in the order of creation
+    LFortran::DeferredSymbolTableIds outer, inner;
+    LFortran::SymbolTable *a, *b, *c;
+    {
+        LFortran::DeferredSymbolTableIds::Scope defer_outer(outer);
+        a = al.make_new<LFortran::SymbolTable>(nullptr);
+        {
+            LFortran::DeferredSymbolTableIds::Scope defer_inner(inner);
+            b = al.make_new<LFortran::SymbolTable>(nullptr);
+        }
+        inner.assign();
+        c = al.make_new<LFortran::SymbolTable>(nullptr);
+    }
+    s = al.make_new<LFortran::SymbolTable>(nullptr);
+    outer.assign();
+    CHECK(a->counter == s->counter + 1);
+    CHECK(b->counter == s->counter + 2);
+    CHECK(c->counter == s->counter + 3);
+}
@@ -1,17 +1,35 @@
 #include <tests/doctest.h>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
+#include <memory>
 
 #include <libasr/bwriter.h>
 #include <libasr/serialization.h>
+#include <libasr/modfile.h>
 #include <lpython/pickle.h>
+#include <lpython/python_serialization.h>
 #include <libasr/asr_utils.h>
 #include <libasr/asr_verify.h>
+#include <libasr/utils.h>
+#include <lpython/parser/parser.h>
+#include <lpython/semantics/python_ast_to_asr.h>
+#include <lpython/utils.h>
 
 using LFortran::TRY;
 using LFortran::string_to_uint64;
 using LFortran::uint64_to_string;
 using LFortran::string_to_uint32;
 using LFortran::uint32_to_string;
+using LFortran::source_hash;
+using LFortran::save_modfile;
+using LFortran::load_modfile;
+using LFortran::modfile_up_to_date;
+using LFortran::read_modfile_header;
+using LFortran::ModfileDependency;
+using LFortran::CompactBinaryWriter;
+using LFortran::CompactBinaryReader;
 
 TEST_CASE("Integer conversion") {
     uint64_t i;
@@ -67,3 +85,360 @@ TEST_CASE("Topological sorting string") {
     CHECK(LFortran::ASRUtils::order_deps(deps) == std::vector<std::string>(
                 {"module_b", "module_a", "module_d", "module_c"}));
 }
+
+TEST_CASE("Modfile source hash") {
+    Allocator al(4*1024);
+    LFortran::Location loc;
+    loc.first = 0;
+    loc.last = 0;
+    LFortran::SymbolTable *global_scope = al.make_new<LFortran::SymbolTable>(nullptr);
+    LFortran::SymbolTable *module_scope = al.make_new<LFortran::SymbolTable>(global_scope);
+    LFortran::ASR::asr_t *m = LFortran::ASR::make_Module_t(al, loc,
+        module_scope, LFortran::s2c(al, "mod1"), nullptr, 0, false, false);
+    module_scope->asr_owner = m;
+    global_scope->add_symbol("mod1", LFortran::ASR::down_cast<LFortran::ASR::symbol_t>(m));
+    LFortran::ASR::TranslationUnit_t *tu = LFortran::ASR::down_cast2<LFortran::ASR::TranslationUnit_t>(
+        LFortran::ASR::make_TranslationUnit_t(al, loc, global_scope, nullptr, 0));
+
+    std::string hash = source_hash("def f():\n    pass\n");
+    CHECK(hash == source_hash("def f():\n    pass\n"));
+    CHECK(hash != source_hash("def g():\n    pass\n"));
+
+    std::string modfile = save_modfile(*tu, hash);
+    CHECK(modfile_up_to_date(modfile, hash));
+    CHECK(!modfile_up_to_date(modfile, source_hash("")));
+    CHECK(!modfile_up_to_date(modfile.substr(0, 10), hash));
+    CHECK(!modfile_up_to_date("", hash));
+
+    LFortran::SymbolTable symtab(nullptr);
+    LFortran::ASR::TranslationUnit_t *tu2 = load_modfile(al, modfile, false, symtab);
+    CHECK(tu2->m_global_scope->n_symbols() == 1);
+    CHECK(LFortran::ASR::is_a<LFortran::ASR::Module_t>(
+        *tu2->m_global_scope->get_symbol("mod1")));
+
+    std::vector<ModfileDependency> deps = {{"mod2", "mod2.py", hash}};
+    modfile = save_modfile(*tu, hash, deps);
+    std::string hash2;
+    std::vector<ModfileDependency> deps2;
+    CHECK(read_modfile_header(modfile, hash2, deps2));
+    CHECK(hash2 == hash);
+    CHECK(deps2.size() == 1);
+    CHECK(deps2[0].module_name == "mod2");
+    CHECK(deps2[0].path == "mod2.py");
+    CHECK(deps2[0].source_hash == hash);
+    LFortran::SymbolTable symtab2(nullptr);
+    tu2 = load_modfile(al, modfile, false, symtab2);
+    CHECK(tu2->m_global_scope->n_symbols() == 1);
+
+    // Loaded from a mapping of the file, the ASR outlives the mapping
+    std::string filename = "test_serialization_mod1.mod";
+    {
+        std::ofstream out(filename, std::ios::binary);
+        out << modfile;
+    }
+    LFortran::MappedFile mapped;
+    CHECK(mapped.open(filename));
+    CHECK(mapped.view() == modfile);
+    LFortran::SymbolTable symtab3(nullptr);
+    tu2 = load_modfile(al, mapped.view(), false, symtab3);
+    mapped.close();
+    std::remove(filename.c_str());
+    CHECK(mapped.view().empty());
+    CHECK(tu2->m_global_scope->get_symbol("mod1") != nullptr);
+    CHECK(std::string(LFortran::ASRUtils::symbol_name(
+        tu2->m_global_scope->get_symbol("mod1"))) == "mod1");
+    CHECK(!mapped.open(filename));
+}
+
+TEST_CASE("Compact binary format") {
+    CompactBinaryWriter w;
+    std::vector<uint64_t> ints = {0, 1, 127, 128, 255, 300, 16383, 16384,
+        4294967295LU, 18446744073709551615LLU};
+    for (uint64_t i : ints) w.write_int64(i);
+    w.write_string("abc");
+    w.write_string("");
+    w.write_string("abc");
+    w.write_int8(200);
+    w.write_float64(-2.5);
+    std::string s = w.get_str();
+
+    CompactBinaryReader r(s);
+    CHECK(r.n_strings() == 2);
+    for (uint64_t i : ints) CHECK(r.read_int64() == i);
+    CHECK(r.read_string() == "abc");
+    CHECK(r.read_string() == "");
+    CHECK(r.read_string() == "abc");
+    CHECK(r.read_int8() == 200);
+    CHECK(r.read_float64() == -2.5);
+    CHECK_THROWS_AS(r.read_int8(), LFortran::LFortranException);
+
+    // Single byte integers are a single byte
+    CompactBinaryWriter w2;
+    w2.write_int64(127);
+    CHECK(w2.get_str().size() == 2);
+}
+
+TEST_CASE("AST serialization") {
+    namespace AST = LFortran::LPython::AST;
+    Allocator al(4*1024);
+    LFortran::Location loc;
+    loc.first = 1;
+    loc.last = 20;
+    // x = y + 3
+    // x = 2.5
+    AST::expr_t *x = AST::down_cast<AST::expr_t>(AST::make_Name_t(al, loc,
+        LFortran::s2c(al, "x"), AST::expr_contextType::Store));
+    AST::expr_t *y = AST::down_cast<AST::expr_t>(AST::make_Name_t(al, loc,
+        LFortran::s2c(al, "y"), AST::expr_contextType::Load));
+    AST::expr_t *i3 = AST::down_cast<AST::expr_t>(AST::make_ConstantInt_t(al,
+        loc, 3, nullptr));
+    AST::expr_t *add = AST::down_cast<AST::expr_t>(AST::make_BinOp_t(al, loc,
+        y, AST::operatorType::Add, i3));
+    AST::expr_t *f = AST::down_cast<AST::expr_t>(AST::make_ConstantFloat_t(al,
+        loc, 2.5, nullptr));
+    AST::expr_t **targets = al.allocate<AST::expr_t*>(1);
+    targets[0] = x;
+    AST::stmt_t **body = al.allocate<AST::stmt_t*>(2);
+    body[0] = AST::down_cast<AST::stmt_t>(AST::make_Assign_t(al, loc, targets,
+        1, add, nullptr));
+    body[1] = AST::down_cast<AST::stmt_t>(AST::make_Assign_t(al, loc, targets,
+        1, f, nullptr));
+    AST::ast_t *m = AST::make_Module_t(al, loc, body, 2, nullptr, 0);
+
+    std::string s = LFortran::LPython::serialize_ast(*m);
+    AST::ast_t *m2 = LFortran::LPython::deserialize_ast(al, s);
+    CHECK(LFortran::LPython::serialize_ast(*m2) == s);
+
+    AST::Module_t *mod = AST::down_cast2<AST::Module_t>(m2);
+    CHECK(mod->base.base.loc.first == 1);
+    CHECK(mod->base.base.loc.last == 20);
+    REQUIRE(mod->n_body == 2);
+    AST::Assign_t *a1 = AST::down_cast<AST::Assign_t>(mod->m_body[0]);
+    AST::Assign_t *a2 = AST::down_cast<AST::Assign_t>(mod->m_body[1]);
+    REQUIRE(a1->n_targets == 1);
+    AST::Name_t *x2 = AST::down_cast<AST::Name_t>(a1->m_targets[0]);
+    CHECK(std::string(x2->m_id) == "x");
+    CHECK(x2->m_ctx == AST::expr_contextType::Store);
+    // Both `x` share the same string
+    CHECK(AST::down_cast<AST::Name_t>(a2->m_targets[0])->m_id == x2->m_id);
+    AST::BinOp_t *add2 = AST::down_cast<AST::BinOp_t>(a1->m_value);
+    CHECK(add2->m_op == AST::operatorType::Add);
+    CHECK(AST::down_cast<AST::ConstantInt_t>(add2->m_right)->m_value == 3);
+    CHECK(AST::down_cast<AST::ConstantFloat_t>(a2->m_value)->m_value == 2.5);
+
+    CHECK_THROWS_AS(LFortran::LPython::deserialize_ast(al,
+        s.substr(0, s.size()-1)), LFortran::LFortranException);
+}
+
+TEST_CASE("ASR outlives the Allocator of the AST") {
+    // As in `lpython`, the AST is parsed into its own Allocator, which is
+    // freed once the strings the ASR shares with it are copied
+    std::string source = R"(def f(x: i32) -> i32:
+    y: i32
+    y = x + 1
+    return y
+
+def g(s: str) -> str:
+    t: str
+    t = s + "abc"
+    return t
+
+def h():
+    print(f(1), g("x"))
+)";
+    Allocator al(4*1024);
+    std::unique_ptr<Allocator> ast_al = std::make_unique<Allocator>(4*1024);
+    LFortran::diag::Diagnostics diagnostics;
+    LFortran::Result<LFortran::LPython::AST::Module_t*> r
+        = LFortran::parse(*ast_al, source, diagnostics);
+    REQUIRE(r.ok);
+    LFortran::CompilerOptions compiler_options;
+    // As a module, so that it can also be saved as a modfile
+    LFortran::Result<LFortran::ASR::TranslationUnit_t*> r2
+        = LFortran::LPython::python_ast_to_asr(al,
+            *(LFortran::LPython::AST::ast_t*)r.result, diagnostics,
+            compiler_options, false, "");
+    REQUIRE(r2.ok);
+    LFortran::ASR::TranslationUnit_t &tu = *r2.result;
+    std::string asr = LFortran::pickle(tu);
+    std::string modfile = save_modfile(tu);
+
+    LFortran::ASRUtils::copy_strings_from(al, tu, *ast_al);
+    ast_al.reset();
+    CHECK(LFortran::asr_verify(tu));
+    CHECK(LFortran::pickle(tu) == asr);
+    CHECK(save_modfile(tu) == modfile);
+}
+
+TEST_CASE("ASR image") {
+    std::string source = R"(from ltypes import i32, f64
+from math import sqrt
+
+def f(x: i32) -> i32:
+    y: i32
+    y = x + 1
+    return y
+
+def g(s: str) -> str:
+    t: str
+    t = s + "abc"
+    return t
+
+def h():
+    a: list[i32]
+    a = [1, 2, 3]
+    print(f(a[0]), g("x"), sqrt(2.0))
+)";
+    Allocator al(4*1024);
+    LFortran::diag::Diagnostics diagnostics;
+    LFortran::Result<LFortran::LPython::AST::Module_t*> r
+        = LFortran::parse(al, source, diagnostics);
+    REQUIRE(r.ok);
+    LFortran::CompilerOptions compiler_options;
+    LFortran::Result<LFortran::ASR::TranslationUnit_t*> r2
+        = LFortran::LPython::python_ast_to_asr(al,
+            *(LFortran::LPython::AST::ast_t*)r.result, diagnostics,
+            compiler_options, false, "");
+    REQUIRE(r2.ok);
+    // A modfile contains a single module
+    LFortran::ASR::TranslationUnit_t &tu = *r2.result;
+    LFortran::SymbolTable *global_scope = al.make_new<LFortran::SymbolTable>(nullptr);
+    global_scope->add_symbol("__main__", tu.m_global_scope->get_symbol("__main__"));
+    LFortran::ASR::TranslationUnit_t &tu1 = *LFortran::ASR::down_cast2<
+        LFortran::ASR::TranslationUnit_t>(LFortran::ASR::make_TranslationUnit_t(
+            al, tu.base.base.loc, global_scope, nullptr, 0));
+    std::string image = LFortran::save_asr_image(tu1);
+    CHECK(LFortran::save_asr_image(tu1) == image);
+
+    // The same ASR, with the same symbol table IDs, in another Allocator
+    Allocator al2(1024);
+    LFortran::ASR::TranslationUnit_t *tu2 = LFortran::load_asr_image(al2,
+        image, true);
+    LFortran::fix_external_symbols(*tu2, *tu.m_global_scope);
+    CHECK(LFortran::asr_verify(*tu2));
+    CHECK(LFortran::pickle(*tu2) == LFortran::pickle(tu1));
+    CHECK(LFortran::serialize(*tu2) == LFortran::serialize(tu1));
+    CHECK(tu2->m_global_scope->asr_owner == (LFortran::ASR::asr_t*)tu2);
+    CHECK(LFortran::save_asr_image(*tu2) == image);
+
+    // The bodies of f, g and h are only loaded when asked for
+    Allocator al3(1024);
+    std::vector<LFortran::ASRImageBody> bodies;
+    LFortran::ASR::TranslationUnit_t *tu3 = LFortran::load_asr_image(al3,
+        image, true, &bodies);
+    LFortran::fix_external_symbols(*tu3, *tu.m_global_scope);
+    CHECK(bodies.size() == 3);
+    CHECK(LFortran::pickle(*tu3) != LFortran::pickle(tu1));
+    for (auto &b : bodies) {
+        LFortran::load_asr_image_body(b);
+    }
+    CHECK(LFortran::asr_verify(*tu3));
+    CHECK(LFortran::pickle(*tu3) == LFortran::pickle(tu1));
+
+    CHECK_THROWS_AS(LFortran::load_asr_image(al2, image.substr(0, 100), false),
+        LFortran::LFortranException);
+    CHECK_THROWS_AS(LFortran::load_asr_image(al2, "LPIMG", false),
+        LFortran::LFortranException);
+    std::string other_layout = image;
+    other_layout[8] ^= 1;
+    CHECK_THROWS_AS(LFortran::load_asr_image(al2, other_layout, false),
+        LFortran::LFortranException);
+}
+
+// The ASR serialization before the compact binary format: fixed width big
+// endian integers and every string written in full
+class FixedWidthASRSerializationVisitor :
+        public LFortran::BinaryWriter,
+        public LFortran::ASR::SerializationBaseVisitor<
+            FixedWidthASRSerializationVisitor>
+{
+public:
+    void write_bool(bool b) {
+        write_int8(b ? 1 : 0);
+    }
+
+    void write_symbol(const LFortran::ASR::symbol_t &x) {
+        write_int64(LFortran::ASRUtils::symbol_parent_symtab(&x)->counter);
+        write_int8(x.type);
+        write_string(LFortran::ASRUtils::symbol_name(&x));
+    }
+};
+
+// The best time of `repeat` runs of `f` in ms
+template <typename F>
+double best_time(size_t repeat, F f) {
+    double best = 0;
+    for (size_t r=0; r < repeat; r++) {
+        auto t1 = std::chrono::high_resolution_clock::now();
+        f();
+        auto t2 = std::chrono::high_resolution_clock::now();
+        double t = std::chrono::duration<double, std::milli>(t2 - t1).count();
+        if (r == 0 || t < best) best = t;
+    }
+    return best;
+}
+
+TEST_CASE("ASR serialization size and speed of the runtime modules"
+        * doctest::skip()) {
+    // A benchmark: it needs the runtime modules next to the test binary
+    // (an in-tree build) and parses them with the external Python parser
+    std::string runtime_library_dir = LFortran::get_runtime_library_dir();
+    LFortran::CompilerOptions compiler_options;
+    size_t fixed_size = 0, compact_size = 0;
+    double fixed_time = 0, compact_time = 0, load_time = 0, image_time = 0;
+    for (const std::string module_name : {"lpython_builtin", "math", "cmath",
+            "random", "statistics"}) {
+        Allocator al(1024*1024);
+        LFortran::diag::Diagnostics diagnostics;
+        std::string infile = runtime_library_dir + "/" + module_name + ".py";
+        LFortran::Result<LFortran::LPython::AST::ast_t*> r
+            = LFortran::parse_python_file(al, runtime_library_dir, infile,
+                diagnostics, false);
+        REQUIRE(r.ok);
+        LFortran::Result<LFortran::ASR::TranslationUnit_t*> r2
+            = LFortran::LPython::python_ast_to_asr(al, *r.result, diagnostics,
+                compiler_options, false, runtime_library_dir);
+        REQUIRE(r2.ok);
+        LFortran::ASR::TranslationUnit_t &tu = *r2.result;
+
+        std::string fixed, compact;
+        fixed_time += best_time(5, [&]() {
+            FixedWidthASRSerializationVisitor v;
+            v.write_int8(tu.base.type);
+            v.visit_asr((LFortran::ASR::asr_t&)tu);
+            fixed = v.get_str();
+        });
+        compact_time += best_time(5, [&]() {
+            compact = LFortran::serialize(tu);
+        });
+        load_time += best_time(5, [&]() {
+            Allocator al2(1024*1024);
+            LFortran::SymbolTable symtab(nullptr);
+            LFortran::deserialize_asr(al2, compact, true, symtab);
+        });
+        std::string image = LFortran::save_asr_image(tu);
+        image_time += best_time(5, [&]() {
+            Allocator al2(1024*1024);
+            LFortran::load_asr_image(al2, image, true);
+        });
+        fixed_size += fixed.size();
+        compact_size += compact.size();
+
+        Allocator al2(1024*1024);
+        LFortran::SymbolTable symtab(nullptr);
+        LFortran::ASR::asr_t *tu2 = LFortran::deserialize_asr(al2, compact,
+            true, symtab);
+        CHECK(LFortran::serialize(*tu2) == compact);
+    }
+    MESSAGE("Runtime modules ASR: fixed width " << fixed_size << " bytes in "
+        << fixed_time << " ms, compact " << compact_size << " bytes in "
+        << compact_time << " ms, loaded in " << load_time << " ms, loaded "
+        << "from an image in " << image_time << " ms");
+    // Most integers fit into a byte or two and symbol names are not repeated
+    CHECK(2*compact_size < fixed_size);
+
+    LFortran::SymbolTable symtab(nullptr);
+    Allocator al(1024);
+    CHECK_THROWS_AS(LFortran::deserialize_asr(al, "LPASR", false, symtab),
+        LFortran::LFortranException);
+}
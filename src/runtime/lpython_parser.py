@@ -1,4 +1,5 @@
 import sys
+import struct
 import python_ast
 import ast
 
@@ -116,29 +117,37 @@ v = python_ast.GenericASTVisitor()
 v.visit(a2)
 
 
-# Serialize
+# Serialize into the compact binary format read by deserialize_ast() (see
+# CompactBinaryWriter in bwriter.h)
+def append_leb128(b, i):
+    while i >= 0x80:
+        b.append((i & 0x7F) | 0x80)
+        i >>= 7
+    b.append(i)
+
 class Serialization(python_ast.SerializationBaseVisitor):
 
     def __init__(self):
+        self.data = bytearray()
+        self.strings = {}
         # Start with a "mod" class
-        self.s = "0 "
+        self.write_int8(0)
 
     def write_int8(self, i):
-        assert i >= 0
-        self.s += str(i) + " "
+        assert i >= 0 and i < 256
+        self.data.append(i)
 
     def write_int64(self, i):
         if i < 0:
             i += 2**64
         assert i >= 0
-        self.s += str(i) + " "
+        append_leb128(self.data, i)
 
     def write_float64(self, f):
-        self.s += str(f) + " "
+        self.data += struct.pack("<d", f)
 
     def write_string(self, s):
-        self.write_int64(len(s))
-        self.s += str(s) + " "
+        self.write_int64(self.strings.setdefault(s, len(self.strings)))
 
     def write_bool(self, b):
         if b:
@@ -146,9 +155,16 @@ class Serialization(python_ast.SerializationBaseVisitor):
         else:
             self.write_int8(0)
 
+    def get_bytes(self):
+        b = bytearray(b"LPAST\x01")
+        append_leb128(b, len(self.strings))
+        for s in self.strings:
+            e = s.encode("utf-8")
+            append_leb128(b, len(e))
+            b += e
+        return bytes(b + self.data)
+
 v = Serialization()
 v.visit(a2)
-#print()
-#print(v.s)
 
-open(filename_out, "w").write(v.s)
+open(filename_out, "wb").write(v.get_bytes())
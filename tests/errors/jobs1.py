@@ -0,0 +1,12 @@
+from ltypes import i32
+
+def f(x: i32) -> i32:
+    return x + 1
+
+def g(x: i32) -> i32:
+    y: i32
+    y = "a"
+    return y
+
+def h(x: i32) -> i32:
+    return f(x) + 1
@@ -0,0 +1,15 @@
+from ltypes import pointer, i16, Pointer, i32
+
+def g(z: Pointer[i32]):
+    print(z)
+
+def f():
+    yptr1: Pointer[i32]
+    y: i32
+    x: i16
+    y = 1
+    x = 2
+    yptr1 = pointer(y)
+    x = yptr1
+
+f()
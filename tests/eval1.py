@@ -0,0 +1,84 @@
+from ltypes import i32, f64
+
+# Evaluated by --fast: the calls in main0() get a constant value unless a
+# comment says otherwise
+
+def triangle(n: i32) -> i32:
+    s: i32
+    i: i32
+    s = 0
+    for i in range(1, n + 1):
+        s += i
+    return s
+
+def last_index(n: i32) -> i32:
+    i: i32
+    for i in range(n):
+        pass
+    return i
+
+def collatz(n: i32) -> i32:
+    steps: i32
+    steps = 0
+    while n != 1:
+        if n % 2 == 0:
+            n = n // 2
+        else:
+            n = 3*n + 1
+        steps += 1
+    return steps
+
+def spin(n: i32) -> i32:
+    i: i32
+    i = 0
+    while i < n:
+        i += 1
+    return i
+
+def sum_to(n: i32) -> i32:
+    if n == 0:
+        return 0
+    return n + sum_to(n - 1)
+
+def fib(n: i32) -> i32:
+    # Exponential without the memoization of the results
+    if n < 2:
+        return n
+    return fib(n - 1) + fib(n - 2)
+
+def power(a: i32, b: i32) -> i32:
+    return a**b
+
+def ratio(x: f64, y: f64) -> f64:
+    return x / y
+
+def greet(n: i32) -> i32:
+    print("hello")
+    return n
+
+g: i32
+g = 5
+
+def add_g(n: i32) -> i32:
+    return n + g
+
+def checked(n: i32) -> i32:
+    assert n > 0
+    return n
+
+def main0():
+    print(triangle(100), last_index(10), collatz(27))
+    # Not evaluated: too many steps
+    print(spin(100000000))
+    # Not evaluated: sum_to(1000) recurses too deep
+    print(sum_to(100), sum_to(1000))
+    print(fib(45))
+    # Not evaluated: power(2, -1), power(3, 40) and ratio(1.0, 0.0)
+    print(power(2, 10), power(-2, 3), power(-1, 3), power(2, -1),
+        power(3, 40))
+    print(ratio(1.0, 4.0), ratio(1.0, 0.0))
+    # Not evaluated: greet() prints, add_g() reads a global and
+    # checked(-1) fails the assert
+    print(greet(1), add_g(1), checked(1), checked(-1))
+
+main0()
@@ -0,0 +1,29 @@
+from ltypes import i32, f64
+from jobs1b import square, cube
+from jobs1c import half
+
+def f(x: i32) -> i32:
+    y: i32
+    y = square(x) + cube(x)
+    return y
+
+def g(x: f64) -> f64:
+    # Needs `abs` from lpython_builtin, which changes the shared symbol
+    # table, so it is lowered sequentially
+    return abs(half(x))
+
+def h(n: i32) -> i32:
+    s: i32
+    i: i32
+    s = 0
+    for i in range(n):
+        s += f(i)
+    return s
+
+def k(x: f64) -> f64:
+    return g(x) + float(h(3))
+
+def main0():
+    print(f(2), g(-3.0), h(4), k(1.0))
+
+main0()
@@ -0,0 +1,7 @@
+from ltypes import i32
+
+def square(x: i32) -> i32:
+    return x*x
+
+def cube(x: i32) -> i32:
+    return x*square(x)
@@ -0,0 +1,4 @@
+from ltypes import f64
+
+def half(x: f64) -> f64:
+    return x/2.0